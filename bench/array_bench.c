@@ -0,0 +1,111 @@
+// measures appending floats to an array.h array (see other/array.h) against
+// the previous int sized container, which called into array_hold for every
+// push, in millions of floats per second
+
+#include "../other/array.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the previous container (see legacy_array.c, built separately so the
+// compiler cannot inline it any more than array.c)
+void* legacy_array_hold(void* array, int count, int item_size);
+int legacy_array_length(const void* array);
+void legacy_array_free(void* array);
+
+#define legacy_array_push(array, value)                                        \
+  do {                                                                         \
+    (array) = legacy_array_hold((array), 1, sizeof(*(array)));                 \
+    (array)[legacy_array_length(array) - 1] = (value);                         \
+  } while (0);
+
+static double seconds(void) {
+  struct timespec time;
+  timespec_get(&time, TIME_UTC);
+  return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+typedef enum append_e {
+  append_legacy_push,
+  append_push,
+  append_reserve_push,
+  append_extend // three floats at a time, like mesh vertices
+} append_e;
+
+static const char* const AppendNames[] = {
+  "legacy push:   ", "push:          ", "reserve, push: ", "extend by 3:   "};
+
+// appends count floats and returns their sum, so nothing is optimized away
+static float append(const append_e mode, const float* source, const int count) {
+  float sum = 0.0f;
+  if (mode == append_legacy_push) {
+    float* floats = NULL;
+    for (int i = 0; i < count; i++) {
+      legacy_array_push(floats, source[i]);
+    }
+    for (int i = 0; i < legacy_array_length(floats); i += 4096) {
+      sum += floats[i];
+    }
+    legacy_array_free(floats);
+    return sum;
+  }
+  float* floats = NULL;
+  if (mode == append_reserve_push) {
+    floats = array_reserve(floats, count, sizeof(float));
+  }
+  if (mode == append_extend) {
+    for (int i = 0; i + 3 <= count; i += 3) {
+      array_extend(floats, &source[i], 3);
+    }
+  } else {
+    for (int i = 0; i < count; i++) {
+      array_push(floats, source[i]);
+    }
+  }
+  if ((uintptr_t)floats % ArrayAlignment != 0) {
+    printf("array items are not %d byte aligned\n", ArrayAlignment);
+  }
+  for (size_t i = 0; i < array_length(floats); i += 4096) {
+    sum += floats[i];
+  }
+  array_free(floats);
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  const int count = argc > 1 ? atoi(argv[1]) : 1 << 24;
+  const int iteration_count = argc > 2 ? atoi(argv[2]) : 10;
+  if (count <= 0 || iteration_count <= 0) {
+    printf("usage: %s [floats] [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  float* source = malloc((size_t)count * sizeof(float));
+  for (int i = 0; i < count; i++) {
+    source[i] = (float)(i % 1000);
+  }
+
+  printf("%d floats, best of %d\n", count, iteration_count);
+  double legacy_rate = 0.0;
+  for (int mode = append_legacy_push; mode <= append_extend; mode++) {
+    double best = 0.0;
+    float sum = 0.0f;
+    for (int i = 0; i < iteration_count; i++) {
+      const double begin = seconds();
+      sum += append((append_e)mode, source, count);
+      const double elapsed = seconds() - begin;
+      const double rate = count / elapsed * 1e-6;
+      best = rate > best ? rate : best;
+    }
+    legacy_rate = mode == append_legacy_push ? best : legacy_rate;
+    printf(
+      "  %s%.1f M floats/s (%.2fx, checksum %.0f)\n", AppendNames[mode], best,
+      best / legacy_rate, sum);
+  }
+
+  free(source);
+  return 0;
+}
@@ -0,0 +1,33 @@
+// the int sized array.h container before aligned storage and bulk appends,
+// kept for array-bench: two ints in front of malloc'd items, every push calls
+// legacy_array_hold
+
+#include <stdlib.h>
+
+void* legacy_array_hold(void* array, const int count, const int item_size) {
+  int* base = array != NULL ? (int*)array - 2 : NULL;
+  if (base == NULL) {
+    base = malloc(sizeof(int) * 2 + (size_t)item_size * count);
+    base[0] = count; // capacity
+    base[1] = count; // occupied
+  } else if (base[1] + count <= base[0]) {
+    base[1] += count;
+  } else {
+    const int needed = base[1] + count;
+    const int capacity = needed > base[0] * 2 ? needed : base[0] * 2;
+    base = realloc(base, sizeof(int) * 2 + (size_t)item_size * capacity);
+    base[0] = capacity;
+    base[1] = needed;
+  }
+  return base + 2;
+}
+
+int legacy_array_length(const void* array) {
+  return array != NULL ? ((const int*)array)[-1] : 0;
+}
+
+void legacy_array_free(void* array) {
+  if (array != NULL) {
+    free((int*)array - 2);
+  }
+}
@@ -0,0 +1,79 @@
+// measures the mip chain filter (see other/mipmap.h), vectorized against
+// scalar, in megapixels of the source texture per second
+
+#include "../other/mipmap.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double seconds(void) {
+  struct timespec time;
+  timespec_get(&time, TIME_UTC);
+  return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+typedef mip_chain_t (*build_fn)(const uint32_t* pixels, int width, int height);
+
+static double megapixels_per_second(
+  const build_fn build, const uint32_t* pixels, const int width,
+  const int height, const int iteration_count) {
+  double best = 0.0;
+  for (int i = 0; i < iteration_count; i++) {
+    const double begin = seconds();
+    mip_chain_t chain = build(pixels, width, height);
+    const double elapsed = seconds() - begin;
+    free_mip_chain(&chain);
+    const double rate = (double)width * height / elapsed * 1e-6;
+    best = rate > best ? rate : best;
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const int size = argc > 1 ? atoi(argv[1]) : 2048;
+  const int iteration_count = argc > 2 ? atoi(argv[2]) : 10;
+  if (size <= 0 || iteration_count <= 0) {
+    printf("usage: %s [size] [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  // noise exercises every table entry, unlike a flat or smooth image
+  uint32_t* pixels = malloc((size_t)size * size * sizeof(uint32_t));
+  uint32_t state = 2463534242u;
+  for (size_t p = 0; p < (size_t)size * size; p++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    pixels[p] = state;
+  }
+
+  mip_chain_t simd = build_mip_chain(pixels, size, size);
+  mip_chain_t scalar = build_mip_chain_scalar(pixels, size, size);
+  int max_difference = 0;
+  const uint8_t* simd_bytes = (const uint8_t*)simd.pixels;
+  const uint8_t* scalar_bytes = (const uint8_t*)scalar.pixels;
+  for (size_t b = 0; b < simd.pixel_count * 4; b++) {
+    const int difference = abs(simd_bytes[b] - scalar_bytes[b]);
+    max_difference = difference > max_difference ? difference : max_difference;
+  }
+  free_mip_chain(&simd);
+  free_mip_chain(&scalar);
+
+  const double simd_rate = megapixels_per_second(
+    build_mip_chain, pixels, size, size, iteration_count);
+  const double scalar_rate = megapixels_per_second(
+    build_mip_chain_scalar, pixels, size, size, iteration_count);
+  printf(
+    "%dx%d, %d levels, best of %d\n", size, size, mip_level_count(size, size),
+    iteration_count);
+  printf("  vectorized: %.1f MP/s\n", simd_rate);
+  printf("  scalar:     %.1f MP/s\n", scalar_rate);
+  printf(
+    "  speedup %.2fx, largest channel difference %d\n",
+    simd_rate / scalar_rate, max_difference);
+
+  free(pixels);
+  return 0;
+}
@@ -0,0 +1,120 @@
+// decodes a corpus of png files with upng and png_decode (see
+// other/png_decode.h), vectorized and scalar, in megapixels per second
+
+#include "../other/mapped_file.h"
+#include "../other/png_decode.h"
+
+#include <upng.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double seconds(void) {
+  struct timespec time;
+  timespec_get(&time, TIME_UTC);
+  return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+typedef uint32_t* (*decode_fn)(
+  const uint8_t* data, size_t size, int* width, int* height);
+
+static uint32_t* decode_upng(
+  const uint8_t* data, const size_t size, int* width, int* height) {
+  upng_t* png = upng_new_from_bytes(data, (unsigned long)size);
+  if (png == NULL) {
+    return NULL;
+  }
+  upng_decode(png);
+  uint32_t* pixels = NULL;
+  if (
+    upng_get_error(png) == UPNG_EOK && upng_get_format(png) == UPNG_RGBA8) {
+    *width = (int)upng_get_width(png);
+    *height = (int)upng_get_height(png);
+    // the copy stands in for keeping the upng_t alive
+    pixels = malloc((size_t)*width * *height * sizeof(uint32_t));
+    memcpy(pixels, upng_get_buffer(png), (size_t)*width * *height * 4);
+  }
+  upng_free(png);
+  return pixels;
+}
+
+// best of iteration_count, 0 when the file doesn't decode
+static double megapixels_per_second(
+  const decode_fn decode, const uint8_t* data, const size_t size,
+  const int iteration_count) {
+  double best = 0.0;
+  for (int i = 0; i < iteration_count; i++) {
+    int width;
+    int height;
+    const double begin = seconds();
+    uint32_t* pixels = decode(data, size, &width, &height);
+    const double elapsed = seconds() - begin;
+    if (pixels == NULL) {
+      return 0.0;
+    }
+    free(pixels);
+    const double rate = (double)width * height / elapsed * 1e-6;
+    best = rate > best ? rate : best;
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const int iteration_count = argc > 1 ? atoi(argv[1]) : 20;
+  if (iteration_count <= 0) {
+    printf("usage: %s [iterations] [png files...]\n", argv[0]);
+    return 1;
+  }
+  const char* default_paths[] = {
+    "assets/textures/f22.png", "assets/textures/redbrick.png"};
+  const char* const* paths = argc > 2 ? (const char* const*)argv + 2
+                                      : default_paths;
+  const int path_count =
+    argc > 2 ? argc - 2 : (int)(sizeof default_paths / sizeof *default_paths);
+
+  printf("best of %d, megapixels per second\n", iteration_count);
+  printf(
+    "%-40s %10s %10s %10s %8s\n", "file", "upng", "sse2", "scalar", "same");
+  for (int p = 0; p < path_count; p++) {
+    mapped_file_t file;
+    if (!mapped_file_open(&file, paths[p])) {
+      printf("%-40s failed to open\n", paths[p]);
+      continue;
+    }
+    const uint8_t* data = (const uint8_t*)file.data;
+
+    // rgba8 files must decode to the same pixels as upng
+    int width = 0;
+    int height = 0;
+    int upng_width = 0;
+    int upng_height = 0;
+    uint32_t* pixels = png_decode(data, file.size, &width, &height);
+    uint32_t* upng_pixels =
+      decode_upng(data, file.size, &upng_width, &upng_height);
+    const char* same = "-";
+    if (pixels != NULL && upng_pixels != NULL) {
+      same = width == upng_width && height == upng_height
+                 && memcmp(
+                      pixels, upng_pixels,
+                      (size_t)width * height * sizeof(uint32_t))
+                      == 0
+               ? "yes"
+               : "NO";
+    }
+    free(pixels);
+    free(upng_pixels);
+
+    printf(
+      "%-40s %10.1f %10.1f %10.1f %8s\n", paths[p],
+      megapixels_per_second(decode_upng, data, file.size, iteration_count),
+      megapixels_per_second(png_decode, data, file.size, iteration_count),
+      megapixels_per_second(
+        png_decode_scalar, data, file.size, iteration_count),
+      same);
+    mapped_file_close(&file);
+  }
+  return 0;
+}
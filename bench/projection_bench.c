@@ -0,0 +1,254 @@
+// measures projecting vertices for projected mode (see
+// other/vertex_projection.h), vectorized and scalar over position blocks,
+// against transforming each vertex by the model, view and projection
+// matrices in turn, the vectorized version skipping the depth reciprocals
+// (when only the projection changed) and split across 1 to N threads, in
+// millions of vertices per second
+
+#include "../other/job_pool.h"
+#include "../other/quantize.h"
+#include "../other/vertex_projection.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double seconds(void) {
+  struct timespec time;
+  timespec_get(&time, TIME_UTC);
+  return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+typedef enum projection_e {
+  projection_per_vertex, // as projected mode used to
+  projection_scalar,
+  projection_vectorized
+} projection_e;
+
+static const char* const ProjectionNames[] = {
+  "per vertex matrices: ", "scalar blocks:       ", "vectorized blocks:   "};
+
+typedef struct scene_t {
+  const float* vertices;
+  position_blocks_t blocks;
+  as_mat34f model;
+  as_mat34f view;
+  as_mat44f projection;
+} scene_t;
+
+static void project(
+  const projection_e mode, const scene_t* scene, float* positions,
+  uint8_t* depth_recips, const bool half_depth_recips) {
+  const int depth_recip_stride =
+    half_depth_recips ? 2 * sizeof(uint16_t) : sizeof(float);
+  if (mode == projection_per_vertex) {
+    for (int v = 0; v < scene->blocks.vertex_count; v++) {
+      const as_point3f vertex = (as_point3f){
+        scene->vertices[v * 3], scene->vertices[v * 3 + 1],
+        scene->vertices[v * 3 + 2]};
+      const as_point3f model_view_vertex = as_mat34f_mul_point3f(
+        &scene->view, as_mat34f_mul_point3f(&scene->model, vertex));
+      const as_point4f projected_vertex =
+        as_mat44f_project_point3f(&scene->projection, model_view_vertex);
+      positions[v * 3] = projected_vertex.x;
+      positions[v * 3 + 1] = projected_vertex.y;
+      positions[v * 3 + 2] = projected_vertex.z;
+      const float depth_recip = 1.0f / model_view_vertex.z;
+      if (half_depth_recips) {
+        const uint16_t half_depth_recip[] = {half_from_float(depth_recip), 0};
+        memcpy(
+          &depth_recips[v * depth_recip_stride], half_depth_recip,
+          sizeof half_depth_recip);
+      } else {
+        memcpy(
+          &depth_recips[v * depth_recip_stride], &depth_recip,
+          sizeof depth_recip);
+      }
+    }
+    return;
+  }
+  // concatenating the matrices is part of the cost
+  const vertex_projection_t projection =
+    make_vertex_projection(&scene->model, &scene->view, &scene->projection);
+  (mode == projection_scalar ? project_position_blocks_scalar
+                             : project_position_blocks)(
+    &scene->blocks, &projection, (uint8_t*)positions, 3 * sizeof(float),
+    depth_recips, depth_recip_stride, half_depth_recips);
+}
+
+static double megavertices_per_second(
+  const projection_e mode, const scene_t* scene, float* positions,
+  uint8_t* depth_recips, const bool half_depth_recips,
+  const int iteration_count) {
+  double best = 0.0;
+  for (int i = 0; i < iteration_count; i++) {
+    const double begin = seconds();
+    project(mode, scene, positions, depth_recips, half_depth_recips);
+    const double elapsed = seconds() - begin;
+    const double rate = (double)scene->blocks.vertex_count / elapsed * 1e-6;
+    best = rate > best ? rate : best;
+  }
+  return best;
+}
+
+static double parallel_megavertices_per_second(
+  const scene_t* scene, job_pool_t* pool, float* positions,
+  uint8_t* depth_recips, const int iteration_count) {
+  double best = 0.0;
+  for (int i = 0; i < iteration_count; i++) {
+    const double begin = seconds();
+    const vertex_projection_t projection =
+      make_vertex_projection(&scene->model, &scene->view, &scene->projection);
+    project_position_blocks_parallel(
+      &scene->blocks, &projection, pool, (uint8_t*)positions,
+      3 * sizeof(float), depth_recips, 2 * sizeof(uint16_t), true);
+    const double elapsed = seconds() - begin;
+    const double rate = (double)scene->blocks.vertex_count / elapsed * 1e-6;
+    best = rate > best ? rate : best;
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const int vertex_count = argc > 1 ? atoi(argv[1]) : 1000000;
+  const int iteration_count = argc > 2 ? atoi(argv[2]) : 20;
+  const int max_thread_count = argc > 3 ? atoi(argv[3]) : 8;
+  if (vertex_count <= 0 || iteration_count <= 0 || max_thread_count <= 0) {
+    printf("usage: %s [vertices] [iterations] [max threads]\n", argv[0]);
+    return 1;
+  }
+
+  // a unit cube of random vertices turned and moved in front of the camera
+  float* vertices = malloc((size_t)vertex_count * 3 * sizeof(float));
+  uint32_t state = 2463534242u;
+  for (size_t i = 0; i < (size_t)vertex_count * 3; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    vertices[i] = (float)state / (float)UINT32_MAX * 2.0f - 1.0f;
+  }
+  const scene_t scene = {
+    .vertices = vertices,
+    .blocks = build_position_blocks(vertices, vertex_count),
+    .model = as_mat34f_mul_mat33f_v(
+      as_mat34f_translation_from_vec3f((as_vec3f){0.5f, -0.25f, 0.0f}),
+      as_mat33f_y_axis_rotation(0.6f)),
+    .view = as_mat34f_translation_from_vec3f((as_vec3f){0.0f, 0.0f, 4.0f}),
+    .projection = as_mat44f_perspective_projection_depth_minus_one_to_one_lh(
+      4.0f / 3.0f, as_radians_from_degrees(60.0f), 0.1f, 100.0f)};
+
+  float* expected_positions = malloc((size_t)vertex_count * 3 * sizeof(float));
+  float* positions = malloc((size_t)vertex_count * 3 * sizeof(float));
+  float* expected_depth_recips = malloc((size_t)vertex_count * sizeof(float));
+  float* depth_recips = malloc((size_t)vertex_count * sizeof(float));
+  project(
+    projection_per_vertex, &scene, expected_positions,
+    (uint8_t*)expected_depth_recips, false);
+  project(
+    projection_vectorized, &scene, positions, (uint8_t*)depth_recips, false);
+  double max_difference = 0.0;
+  for (size_t i = 0; i < (size_t)vertex_count * 3; i++) {
+    max_difference =
+      fmax(max_difference, fabs(positions[i] - expected_positions[i]));
+  }
+  for (int v = 0; v < vertex_count; v++) {
+    max_difference = fmax(
+      max_difference,
+      fabs(depth_recips[v] - expected_depth_recips[v])
+        / fabs(expected_depth_recips[v]));
+  }
+  // half depth reciprocals must round like half_from_float
+  project(
+    projection_scalar, &scene, expected_positions,
+    (uint8_t*)expected_depth_recips, true);
+  project(
+    projection_vectorized, &scene, positions, (uint8_t*)depth_recips, true);
+  const int half_mismatch_count = memcmp(
+    expected_depth_recips, depth_recips, (size_t)vertex_count * sizeof(float));
+
+  printf("%d vertices, best of %d\n", vertex_count, iteration_count);
+  double rates[3][2];
+  for (int m = 0; m < 3; m++) {
+    for (int h = 0; h < 2; h++) {
+      rates[m][h] = megavertices_per_second(
+        (projection_e)m, &scene, positions, (uint8_t*)depth_recips, h == 1,
+        iteration_count);
+    }
+    printf(
+      "  %s%7.1f Mvertices/s (float 1/z), %7.1f Mvertices/s (half 1/z)\n",
+      ProjectionNames[m], rates[m][0], rates[m][1]);
+  }
+  printf(
+    "  vectorized speedup %.2fx (float 1/z), %.2fx (half 1/z)\n",
+    rates[projection_vectorized][0] / rates[projection_per_vertex][0],
+    rates[projection_vectorized][1] / rates[projection_per_vertex][1]);
+  printf(
+    "  largest difference %g, half 1/z %s half_from_float\n", max_difference,
+    half_mismatch_count == 0 ? "matches" : "DIFFERS from");
+
+  // positions alone must match the positions written with the depths
+  const vertex_projection_t projection =
+    make_vertex_projection(&scene.model, &scene.view, &scene.projection);
+  double positions_only_rate = 0.0;
+  for (int i = 0; i < iteration_count; i++) {
+    const double begin = seconds();
+    project_position_blocks(
+      &scene.blocks, &projection, (uint8_t*)positions, 3 * sizeof(float),
+      NULL, 0, false);
+    const double elapsed = seconds() - begin;
+    const double rate = (double)vertex_count / elapsed * 1e-6;
+    positions_only_rate =
+      rate > positions_only_rate ? rate : positions_only_rate;
+  }
+  const bool positions_match =
+    memcmp(
+      expected_positions, positions, (size_t)vertex_count * 3 * sizeof(float))
+    == 0;
+  printf(
+    "  vectorized blocks, positions only: %7.1f Mvertices/s (%.2fx)%s\n",
+    positions_only_rate, positions_only_rate / rates[projection_vectorized][0],
+    positions_match ? "" : ", output DIFFERS");
+
+  // split across threads, the output must not change
+  printf("  vectorized blocks, half 1/z, split across threads:\n");
+  double single_thread_rate = 0.0;
+  for (int t = 1; t <= max_thread_count; t++) {
+    job_pool_t* pool = job_pool_create(t);
+    const vertex_projection_t projection =
+      make_vertex_projection(&scene.model, &scene.view, &scene.projection);
+    memset(positions, 0, (size_t)vertex_count * 3 * sizeof(float));
+    memset(depth_recips, 0, (size_t)vertex_count * sizeof(float));
+    const int job_count = project_position_blocks_parallel(
+      &scene.blocks, &projection, pool, (uint8_t*)positions,
+      3 * sizeof(float), (uint8_t*)depth_recips, 2 * sizeof(uint16_t), true);
+    const bool matches =
+      memcmp(
+        expected_positions, positions,
+        (size_t)vertex_count * 3 * sizeof(float))
+        == 0
+      && memcmp(
+           expected_depth_recips, depth_recips,
+           (size_t)vertex_count * sizeof(float))
+           == 0;
+    const double rate = parallel_megavertices_per_second(
+      &scene, pool, positions, (uint8_t*)depth_recips, iteration_count);
+    single_thread_rate = t == 1 ? rate : single_thread_rate;
+    printf(
+      "    %2d thread(s), %2d job(s): %7.1f Mvertices/s (%.2fx)%s\n", t,
+      job_count, rate, rate / single_thread_rate,
+      matches ? "" : ", output DIFFERS");
+    job_pool_destroy(pool);
+  }
+
+  free(vertices);
+  free(expected_positions);
+  free(positions);
+  free(expected_depth_recips);
+  free(depth_recips);
+  position_blocks_t blocks = scene.blocks;
+  free_position_blocks(&blocks);
+  return 0;
+}
@@ -25,10 +25,17 @@
 #include <as-ops.h>
 #include <float.h>
 
+#include "other/arena.h"
 #include "other/array.h"
+#include "other/asset_loader.h"
 #include "other/camera.h"
+#include "other/file_watcher.h"
 #include "other/frustum.h"
+#include "other/job_pool.h"
 #include "other/mesh.h"
+#include "other/meshlet.h"
+#include "other/texture_residency.h"
+#include "other/vertex_projection.h"
 
 #include "sokol-sdl-graphics-backend.h"
 
@@ -45,6 +52,18 @@ typedef enum movement_e {
 typedef enum view_e { view_perspective, view_orthographic } view_e;
 // mode of rendering
 typedef enum mode_e { mode_standard, mode_projected } mode_e;
+// how the model vertex attributes are laid out in vertex buffers
+typedef enum vertex_layout_e {
+  vertex_layout_split, // one buffer per attribute
+  vertex_layout_interleaved // one buffer with all attributes of a vertex
+} vertex_layout_e;
+
+// tightly packed values of one vertex attribute
+typedef struct vertex_stream_t {
+  const void* data;
+  int size; // bytes per vertex
+  sg_vertex_format format;
+} vertex_stream_t;
 
 camera_t g_camera = {0};
 int8_t g_movement = 0;
@@ -54,45 +73,709 @@ mode_e g_mode = mode_standard;
 view_e g_view = view_orthographic;
 as_mat34f g_model_transform = {0};
 bool g_affine = false;
+vertex_layout_e g_vertex_layout = vertex_layout_split;
+// projected mode projects in the vertex shader instead of reproject_model,
+// blending from the standard positions by g_morph
+bool g_project_on_gpu = false;
+float g_morph = 1.0f;
 
-static void update_movement(const float delta_time) {
+static void update_movement(camera_t* camera, const float delta_time) {
   const float speed = delta_time * 4.0f;
   if ((g_movement & movement_forward) != 0) {
-    const as_mat33f rotation = camera_rotation(&g_camera);
-    g_camera.pivot = as_point3f_add_vec3f(
-      g_camera.pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.z = speed}));
+    const as_mat33f rotation = camera_rotation(camera);
+    camera->pivot = as_point3f_add_vec3f(
+      camera->pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.z = speed}));
   }
   if ((g_movement & movement_left) != 0) {
-    const as_mat33f rotation = camera_rotation(&g_camera);
-    g_camera.pivot = as_point3f_add_vec3f(
-      g_camera.pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.x = -speed}));
+    const as_mat33f rotation = camera_rotation(camera);
+    camera->pivot = as_point3f_add_vec3f(
+      camera->pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.x = -speed}));
   }
   if ((g_movement & movement_backward) != 0) {
-    const as_mat33f rotation = camera_rotation(&g_camera);
-    g_camera.pivot = as_point3f_add_vec3f(
-      g_camera.pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.z = -speed}));
+    const as_mat33f rotation = camera_rotation(camera);
+    camera->pivot = as_point3f_add_vec3f(
+      camera->pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.z = -speed}));
   }
   if ((g_movement & movement_right) != 0) {
-    const as_mat33f rotation = camera_rotation(&g_camera);
-    g_camera.pivot = as_point3f_add_vec3f(
-      g_camera.pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.x = speed}));
+    const as_mat33f rotation = camera_rotation(camera);
+    camera->pivot = as_point3f_add_vec3f(
+      camera->pivot, as_mat33f_mul_vec3f(&rotation, (as_vec3f){.x = speed}));
   }
   if ((g_movement & movement_down) != 0) {
-    g_camera.pivot =
-      as_point3f_add_vec3f(g_camera.pivot, (as_vec3f){.y = -speed});
+    camera->pivot =
+      as_point3f_add_vec3f(camera->pivot, (as_vec3f){.y = -speed});
   }
   if ((g_movement & movement_up) != 0) {
-    g_camera.pivot =
-      as_point3f_add_vec3f(g_camera.pivot, (as_vec3f){.y = speed});
+    camera->pivot = as_point3f_add_vec3f(camera->pivot, (as_vec3f){.y = speed});
   }
 }
 
+// scales and offsets normalized positions back into the mesh bounds
+static as_mat34f dequantize_transform(const quantized_vertices_t* quantized) {
+  const float* scale = quantized->position_scale;
+  const float* offset = quantized->position_offset;
+  // clang-format off
+  return (as_mat34f){.elem = {scale[0], 0.0f,     0.0f,     offset[0],
+                              0.0f,     scale[1], 0.0f,     offset[1],
+                              0.0f,     0.0f,     scale[2], offset[2]}};
+  // clang-format on
+}
+
+static int vertex_streams_stride(
+  const vertex_stream_t* streams, const int stream_count) {
+  int stride = 0;
+  for (int s = 0; s < stream_count; s++) {
+    stride += streams[s].size;
+  }
+  return stride;
+}
+
+// one vertex buffer per stream
+static sg_layout_desc split_vertex_layout(
+  const vertex_stream_t* streams, const int stream_count) {
+  sg_layout_desc layout = {0};
+  for (int s = 0; s < stream_count; s++) {
+    layout.attrs[s] =
+      (sg_vertex_attr_desc){.format = streams[s].format, .buffer_index = s};
+  }
+  return layout;
+}
+
+// the first stream_count streams read from vertex buffer 0, stride may be
+// larger than the streams read to skip attributes
+static sg_layout_desc interleaved_vertex_layout(
+  const vertex_stream_t* streams, const int stream_count, const int stride) {
+  sg_layout_desc layout = {.buffers[0].stride = stride};
+  for (int s = 0, offset = 0; s < stream_count; s++) {
+    layout.attrs[s] =
+      (sg_vertex_attr_desc){.format = streams[s].format, .offset = offset};
+    offset += streams[s].size;
+  }
+  return layout;
+}
+
+// copies the streams into one buffer of vertex_streams_stride bytes per
+// vertex (streams without data are cleared)
+static uint8_t* interleave_vertex_streams(
+  const vertex_stream_t* streams, const int stream_count,
+  const int vertex_count) {
+  const int stride = vertex_streams_stride(streams, stream_count);
+  uint8_t* interleaved = array_hold(NULL, vertex_count * stride, 1);
+  for (int v = 0; v < vertex_count; v++) {
+    uint8_t* vertex = &interleaved[v * stride];
+    for (int s = 0; s < stream_count; s++) {
+      const vertex_stream_t* stream = &streams[s];
+      if (stream->data != NULL) {
+        memcpy(
+          vertex, (const uint8_t*)stream->data + v * stream->size,
+          stream->size);
+      } else {
+        memset(vertex, 0, stream->size);
+      }
+      vertex += stream->size;
+    }
+  }
+  return interleaved;
+}
+
+// sphere around the center of the bounds of the vertices
+static void bounding_sphere(
+  const float* vertices, const int vertex_count, as_point3f* center,
+  float* radius) {
+  float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  for (int v = 0; v < vertex_count; v++) {
+    for (int a = 0; a < 3; a++) {
+      min[a] = fminf(min[a], vertices[v * 3 + a]);
+      max[a] = fmaxf(max[a], vertices[v * 3 + a]);
+    }
+  }
+  *center = vertex_count > 0 ? (as_point3f){(min[0] + max[0]) * 0.5f,
+                                            (min[1] + max[1]) * 0.5f,
+                                            (min[2] + max[2]) * 0.5f}
+                             : (as_point3f){0};
+  float radius_squared = 0.0f;
+  for (int v = 0; v < vertex_count; v++) {
+    const float* vertex = &vertices[v * 3];
+    const as_vec3f offset = {
+      vertex[0] - center->x, vertex[1] - center->y, vertex[2] - center->z};
+    radius_squared =
+      fmaxf(radius_squared, as_vec3f_dot_vec3f(offset, offset));
+  }
+  *radius = sqrtf(radius_squared);
+}
+
+// pixels covered by one model unit at distance from the camera
+static float pixels_per_unit(
+  const float distance, const float vertical_fov_radians,
+  const float viewport_height) {
+  return viewport_height * 0.5f
+       / (tanf(vertical_fov_radians * 0.5f) * fmaxf(distance, FLT_EPSILON));
+}
+
+// coarsest level of detail whose error covers at most max_pixel_error
+// pixels on screen
+static int select_lod(
+  const mesh_buffers_t* buffers, const float pixels_per_unit,
+  const float max_pixel_error) {
+  int lod = 0;
+  for (int l = 1; l < buffers->lod_count; l++) {
+    if (buffers->lods[l].error * pixels_per_unit <= max_pixel_error) {
+      lod = l;
+    }
+  }
+  return lod;
+}
+
+// meshlets tested by cull_mesh_meshlets and how many were rejected
+typedef struct meshlet_cull_stats_t {
+  int meshlet_count;
+  int frustum_culled_count;
+  int backface_culled_count;
+} meshlet_cull_stats_t;
+
+// tests every meshlet of the level of detail, meshlet_visible is indexed
+// like buffers->meshlets
+static meshlet_cull_stats_t cull_mesh_meshlets(
+  const mesh_buffers_t* buffers, const int lod,
+  const meshlet_culling_t* culling, bool* meshlet_visible) {
+  meshlet_cull_stats_t stats = {0};
+  const mesh_lod_t* mesh_lod = &buffers->lods[lod];
+  for (int s = mesh_lod->submesh_offset;
+       s < mesh_lod->submesh_offset + mesh_lod->submesh_count; s++) {
+    const submesh_t* submesh = &buffers->submeshes[s];
+    for (int m = submesh->meshlet_offset;
+         m < submesh->meshlet_offset + submesh->meshlet_count; m++) {
+      const meshlet_cull_e cull = cull_meshlet(&buffers->meshlets[m], culling);
+      meshlet_visible[m] = cull == meshlet_cull_visible;
+      stats.frustum_culled_count += cull == meshlet_cull_frustum;
+      stats.backface_culled_count += cull == meshlet_cull_backface;
+      stats.meshlet_count++;
+    }
+  }
+  return stats;
+}
+
+// binds the vertex streams offset to the first vertex of the submesh,
+// vertex_strides holds the stride of each bound vertex buffer
+static void apply_submesh_bindings(
+  sg_bindings* bindings, const submesh_t* submesh, const int* vertex_strides) {
+  for (int v = 0; v < 3; v++) {
+    if (bindings->vertex_buffers[v].id != SG_INVALID_ID) {
+      bindings->vertex_buffer_offsets[v] =
+        submesh->vertex_offset * vertex_strides[v];
+    }
+  }
+  sg_apply_bindings(bindings);
+}
+
+// draws each submesh of the level of detail, with meshlet_visible (NULL
+// draws everything) only the visible meshlets are drawn, each run of
+// consecutive visible meshlets with a single draw, returns the draw count
+static int draw_mesh_buffers(
+  sg_bindings* bindings, const mesh_buffers_t* buffers, const int lod,
+  const int* vertex_strides, const bool* meshlet_visible) {
+  int draw_count = 0;
+  const mesh_lod_t* mesh_lod = &buffers->lods[lod];
+  for (int s = mesh_lod->submesh_offset;
+       s < mesh_lod->submesh_offset + mesh_lod->submesh_count; s++) {
+    const submesh_t* submesh = &buffers->submeshes[s];
+    if (meshlet_visible == NULL || submesh->meshlet_count == 0) {
+      apply_submesh_bindings(bindings, submesh, vertex_strides);
+      sg_draw(submesh->index_offset, submesh->index_count, 1);
+      draw_count++;
+      continue;
+    }
+    bool bound = false;
+    const int meshlet_end = submesh->meshlet_offset + submesh->meshlet_count;
+    for (int m = submesh->meshlet_offset; m < meshlet_end;) {
+      if (!meshlet_visible[m]) {
+        m++;
+        continue;
+      }
+      // meshlets are stored in index order
+      const int index_offset = buffers->meshlets[m].index_offset;
+      int index_count = 0;
+      for (; m < meshlet_end && meshlet_visible[m]; m++) {
+        index_count += buffers->meshlets[m].index_count;
+      }
+      if (!bound) {
+        apply_submesh_bindings(bindings, submesh, vertex_strides);
+        bound = true;
+      }
+      sg_draw(index_offset, index_count, 1);
+      draw_count++;
+    }
+  }
+  return draw_count;
+}
+
+// shaders shared by every model pipeline
+typedef struct model_shaders_t {
+  sg_shader standard;
+  sg_shader projected;
+  sg_shader projected_morph;
+} model_shaders_t;
+
+// cpu streams, gpu buffers, pipelines and bindings of a loaded model
+typedef struct model_resources_t {
+  model_t model;
+  // used to pick a level of detail from the size of the model on screen
+  as_point3f center;
+  float radius;
+  // quantized meshes upload SHORT4N positions and half float uvs (and depth
+  // reciprocals), positions are restored by folding dequantize into the
+  // model transform
+  as_mat34f dequantize;
+  sg_vertex_format depth_recip_format;
+  // model.buffers.vertices regrouped for reproject_model
+  position_blocks_t position_blocks;
+  vertex_stream_t standard_streams[2];
+  vertex_stream_t projected_streams[3];
+  int standard_vertex_stride;
+  int projected_vertex_stride;
+  // streams for vertex_layout_interleaved (uvs never change, only the
+  // positions and depth reciprocals of the projected stream are rewritten)
+  uint8_t* standard_interleaved_vertices;
+  uint8_t* projected_interleaved_vertices;
+  sg_buffer standard_vertex_buffer;
+  sg_buffer projected_vertex_buffer;
+  sg_buffer uv_buffer;
+  sg_buffer depth_recip_buffer;
+  sg_buffer standard_interleaved_buffer;
+  sg_buffer projected_interleaved_buffer;
+  sg_buffer index_buffer;
+  int texture_id; // owned by the texture residency
+  sg_pipeline pip_standard;
+  sg_pipeline pip_projected;
+  sg_pipeline pip_projected_affine;
+  sg_pipeline pip_standard_interleaved;
+  sg_pipeline pip_projected_interleaved;
+  sg_pipeline pip_projected_affine_interleaved;
+  // project through the pinned camera in the vertex shader, reading the
+  // standard bindings (see g_project_on_gpu)
+  sg_pipeline pip_projected_morph;
+  sg_pipeline pip_projected_morph_interleaved;
+  sg_bindings bind_standard;
+  sg_bindings bind_projected;
+  sg_bindings bind_projected_affine;
+  sg_bindings bind_standard_interleaved;
+  sg_bindings bind_projected_interleaved;
+  // vertex buffer strides of the bindings above
+  int standard_split_vertex_strides[2];
+  int projected_split_vertex_strides[3];
+  int standard_interleaved_vertex_strides[1];
+  int projected_interleaved_vertex_strides[1];
+} model_resources_t;
+
+// bounds, vertex streams and the arrays derived from resources->model
+static void prepare_model_data(model_resources_t* resources) {
+  // gpu ready model data (welded at import or mapped from the cache)
+  const mesh_buffers_t* buffers = &resources->model.buffers;
+  const int vertex_count = buffers->vertex_count;
+
+  bounding_sphere(
+    buffers->vertices, vertex_count, &resources->center, &resources->radius);
+  resources->position_blocks =
+    build_position_blocks(buffers->vertices, vertex_count);
+
+  const quantized_vertices_t* quantized_vertices = &buffers->quantized;
+  const bool quantized = quantized_vertices->positions != NULL;
+  resources->dequantize = quantized
+                        ? dequantize_transform(quantized_vertices)
+                        : as_mat34f_identity();
+
+  resources->depth_recip_format =
+    quantized ? SG_VERTEXFORMAT_HALF2 : SG_VERTEXFORMAT_FLOAT;
+  const int depth_recip_size =
+    quantized ? 2 * sizeof(uint16_t) : sizeof(float);
+
+  const vertex_stream_t uv_stream =
+    quantized ? (vertex_stream_t){.data = quantized_vertices->uvs,
+                                  .size = 2 * sizeof(uint16_t),
+                                  .format = SG_VERTEXFORMAT_HALF2}
+              : (vertex_stream_t){.data = buffers->uvs,
+                                  .size = 2 * sizeof(float),
+                                  .format = SG_VERTEXFORMAT_FLOAT2};
+  resources->standard_streams[0] =
+    quantized ? (vertex_stream_t){.data = quantized_vertices->positions,
+                                  .size = 4 * sizeof(int16_t),
+                                  .format = SG_VERTEXFORMAT_SHORT4N}
+              : (vertex_stream_t){.data = buffers->vertices,
+                                  .size = 3 * sizeof(float),
+                                  .format = SG_VERTEXFORMAT_FLOAT3};
+  resources->standard_streams[1] = uv_stream;
+  // projected positions and depth reciprocals have no data until
+  // reproject_model writes them (into frame scratch for the split layout)
+  resources->projected_streams[0] = (vertex_stream_t){
+    .size = 3 * sizeof(float), .format = SG_VERTEXFORMAT_FLOAT3};
+  resources->projected_streams[1] = uv_stream;
+  resources->projected_streams[2] = (vertex_stream_t){
+    .size = depth_recip_size, .format = resources->depth_recip_format};
+  const vertex_stream_t* standard_streams = resources->standard_streams;
+  const vertex_stream_t* projected_streams = resources->projected_streams;
+  resources->standard_vertex_stride =
+    vertex_streams_stride(standard_streams, 2);
+  resources->projected_vertex_stride =
+    vertex_streams_stride(projected_streams, 3);
+  printf(
+    "Model vertices: %d bytes (standard), %d bytes (projected)\n",
+    vertex_count * resources->standard_vertex_stride,
+    vertex_count * resources->projected_vertex_stride);
+
+  resources->standard_interleaved_vertices =
+    interleave_vertex_streams(standard_streams, 2, vertex_count);
+  resources->projected_interleaved_vertices =
+    interleave_vertex_streams(projected_streams, 3, vertex_count);
+}
+
+static void release_model_data(model_resources_t* resources) {
+  free_mesh_buffers(&resources->model.buffers);
+  free_texture(&resources->model.texture);
+  free_position_blocks(&resources->position_blocks);
+  array_free(resources->standard_interleaved_vertices);
+  array_free(resources->projected_interleaved_vertices);
+}
+
+// writes the vertex and index data of resources->model to its dynamic
+// buffers (at most once per frame)
+static void upload_model_data(const model_resources_t* resources) {
+  const mesh_buffers_t* buffers = &resources->model.buffers;
+  const int vertex_count = buffers->vertex_count;
+  sg_update_buffer(
+    resources->standard_vertex_buffer,
+    &(sg_range){
+      .ptr = resources->standard_streams[0].data,
+      .size = vertex_count * resources->standard_streams[0].size});
+  sg_update_buffer(
+    resources->uv_buffer,
+    &(sg_range){
+      .ptr = resources->standard_streams[1].data,
+      .size = vertex_count * resources->standard_streams[1].size});
+  sg_update_buffer(
+    resources->standard_interleaved_buffer,
+    &(sg_range){
+      .ptr = resources->standard_interleaved_vertices,
+      .size = array_length(resources->standard_interleaved_vertices)});
+  sg_update_buffer(
+    resources->index_buffer,
+    &(sg_range){
+      .ptr = buffers->indices,
+      .size = buffers->index_count * buffers->index_size});
+}
+
+// takes ownership of the model and creates everything needed to draw it,
+// the texture is handed to the residency (loaded again from the texture of
+// request if evicted) and its pixels are released unless it's cpu sampled
+static model_resources_t create_model_resources(
+  const model_t model, const model_shaders_t* shaders,
+  texture_residency_t* residency, const model_request_t* request) {
+  model_resources_t resources = {.model = model};
+  prepare_model_data(&resources);
+  const mesh_buffers_t* buffers = &resources.model.buffers;
+  const int vertex_count = buffers->vertex_count;
+  const sg_index_type index_type = buffers->index_size == sizeof(uint32_t)
+                                   ? SG_INDEXTYPE_UINT32
+                                   : SG_INDEXTYPE_UINT16;
+  const vertex_stream_t* standard_streams = resources.standard_streams;
+  const vertex_stream_t* projected_streams = resources.projected_streams;
+
+  // the buffers and image holding model data are dynamic so a reload of the
+  // same size can overwrite them (dynamic buffers can't be created with
+  // data, see upload_model_data), projected buffers are rewritten on frames
+  // the model, the pinned camera or its projection changed and written
+  // before they are first drawn (see reproject_model), sokol cycles each
+  // through SG_NUM_INFLIGHT_FRAMES
+  // backing buffers so an update never waits on a frame the gpu still reads
+  resources.standard_vertex_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_DYNAMIC,
+    .size = vertex_count * standard_streams[0].size});
+  resources.projected_vertex_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_STREAM,
+    .size = vertex_count * projected_streams[0].size});
+  resources.uv_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_DYNAMIC,
+    .size = vertex_count * standard_streams[1].size});
+  resources.depth_recip_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_STREAM,
+    .size = vertex_count * projected_streams[2].size});
+  resources.standard_interleaved_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_DYNAMIC,
+    .size = array_length(resources.standard_interleaved_vertices)});
+  resources.projected_interleaved_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .usage = SG_USAGE_STREAM,
+    .size = array_length(resources.projected_interleaved_vertices)});
+  resources.index_buffer = sg_make_buffer(&(sg_buffer_desc){
+    .type = SG_BUFFERTYPE_INDEXBUFFER,
+    .usage = SG_USAGE_DYNAMIC,
+    .size = buffers->index_count * buffers->index_size});
+
+  const sg_pipeline_desc pip_projected_desc = (sg_pipeline_desc){
+    .shader = shaders->projected,
+    .layout = split_vertex_layout(projected_streams, 3),
+    .index_type = index_type,
+    .depth =
+      {
+        .compare = SG_COMPAREFUNC_LESS_EQUAL,
+        .write_enabled = true,
+      },
+    .cull_mode = SG_CULLMODE_BACK,
+    .face_winding = SG_FACEWINDING_CW};
+
+  resources.pip_projected = sg_make_pipeline(&pip_projected_desc);
+
+  const sg_pipeline_desc pip_standard_desc = (sg_pipeline_desc){
+    .shader = shaders->standard,
+    .layout = split_vertex_layout(standard_streams, 2),
+    .index_type = index_type,
+    .depth =
+      {
+        .compare = SG_COMPAREFUNC_LESS_EQUAL,
+        .write_enabled = true,
+      },
+    .cull_mode = SG_CULLMODE_BACK,
+    .face_winding = SG_FACEWINDING_CW};
+
+  resources.pip_standard = sg_make_pipeline(&pip_standard_desc);
+
+  // affine mapping reads the projected positions and uvs with the standard
+  // shader (skipping the depth reciprocal)
+  sg_pipeline_desc pip_projected_affine_desc = pip_standard_desc;
+  pip_projected_affine_desc.layout = split_vertex_layout(projected_streams, 2);
+  resources.pip_projected_affine =
+    sg_make_pipeline(&pip_projected_affine_desc);
+
+  // the same pipelines reading every attribute from vertex buffer 0
+  sg_pipeline_desc pip_projected_interleaved_desc = pip_projected_desc;
+  pip_projected_interleaved_desc.layout = interleaved_vertex_layout(
+    projected_streams, 3, resources.projected_vertex_stride);
+  resources.pip_projected_interleaved =
+    sg_make_pipeline(&pip_projected_interleaved_desc);
+
+  sg_pipeline_desc pip_standard_interleaved_desc = pip_standard_desc;
+  pip_standard_interleaved_desc.layout = interleaved_vertex_layout(
+    standard_streams, 2, resources.standard_vertex_stride);
+  resources.pip_standard_interleaved =
+    sg_make_pipeline(&pip_standard_interleaved_desc);
+
+  sg_pipeline_desc pip_projected_affine_interleaved_desc = pip_standard_desc;
+  pip_projected_affine_interleaved_desc.layout = interleaved_vertex_layout(
+    projected_streams, 2, resources.projected_vertex_stride);
+  resources.pip_projected_affine_interleaved =
+    sg_make_pipeline(&pip_projected_affine_interleaved_desc);
+
+  sg_pipeline_desc pip_projected_morph_desc = pip_standard_desc;
+  pip_projected_morph_desc.shader = shaders->projected_morph;
+  resources.pip_projected_morph = sg_make_pipeline(&pip_projected_morph_desc);
+
+  sg_pipeline_desc pip_projected_morph_interleaved_desc =
+    pip_standard_interleaved_desc;
+  pip_projected_morph_interleaved_desc.shader = shaders->projected_morph;
+  resources.pip_projected_morph_interleaved =
+    sg_make_pipeline(&pip_projected_morph_interleaved_desc);
+
+  upload_model_data(&resources);
+  resources.texture_id = texture_residency_add(
+    residency, request->texture_path, &request->texture_options,
+    &resources.model.texture);
+  release_texture_pixels(&resources.model.texture);
+
+  // resource bindings (the image is set when drawing, see
+  // texture_residency_use)
+  resources.bind_projected = (sg_bindings){
+    .vertex_buffers =
+      {[0] = resources.projected_vertex_buffer,
+       [1] = resources.uv_buffer,
+       [2] = resources.depth_recip_buffer},
+    .vertex_buffer_offsets = {[0] = 0, [1] = 0, [2] = 0},
+    .index_buffer = resources.index_buffer};
+
+  resources.bind_projected_affine = (sg_bindings){
+    .vertex_buffers =
+      {[0] = resources.projected_vertex_buffer, [1] = resources.uv_buffer},
+    .vertex_buffer_offsets = {[0] = 0, [1] = 0},
+    .index_buffer = resources.index_buffer};
+
+  resources.bind_standard = (sg_bindings){
+    .vertex_buffers =
+      {[0] = resources.standard_vertex_buffer, [1] = resources.uv_buffer},
+    .vertex_buffer_offsets = {[0] = 0, [1] = 0},
+    .index_buffer = resources.index_buffer};
+
+  resources.bind_projected_interleaved = (sg_bindings){
+    .vertex_buffers = {[0] = resources.projected_interleaved_buffer},
+    .vertex_buffer_offsets = {[0] = 0},
+    .index_buffer = resources.index_buffer};
+
+  resources.bind_standard_interleaved = (sg_bindings){
+    .vertex_buffers = {[0] = resources.standard_interleaved_buffer},
+    .vertex_buffer_offsets = {[0] = 0},
+    .index_buffer = resources.index_buffer};
+
+  for (int s = 0; s < 2; s++) {
+    resources.standard_split_vertex_strides[s] = standard_streams[s].size;
+  }
+  for (int s = 0; s < 3; s++) {
+    resources.projected_split_vertex_strides[s] = projected_streams[s].size;
+  }
+  resources.standard_interleaved_vertex_strides[0] =
+    resources.standard_vertex_stride;
+  resources.projected_interleaved_vertex_strides[0] =
+    resources.projected_vertex_stride;
+
+  return resources;
+}
+
+static void destroy_model_resources(
+  model_resources_t* resources, texture_residency_t* residency) {
+  sg_destroy_buffer(resources->standard_vertex_buffer);
+  sg_destroy_buffer(resources->projected_vertex_buffer);
+  sg_destroy_buffer(resources->uv_buffer);
+  sg_destroy_buffer(resources->depth_recip_buffer);
+  sg_destroy_buffer(resources->standard_interleaved_buffer);
+  sg_destroy_buffer(resources->projected_interleaved_buffer);
+  sg_destroy_buffer(resources->index_buffer);
+  sg_destroy_pipeline(resources->pip_standard);
+  sg_destroy_pipeline(resources->pip_projected);
+  sg_destroy_pipeline(resources->pip_projected_affine);
+  sg_destroy_pipeline(resources->pip_standard_interleaved);
+  sg_destroy_pipeline(resources->pip_projected_interleaved);
+  sg_destroy_pipeline(resources->pip_projected_affine_interleaved);
+  sg_destroy_pipeline(resources->pip_projected_morph);
+  sg_destroy_pipeline(resources->pip_projected_morph_interleaved);
+  texture_residency_remove(residency, resources->texture_id);
+
+  release_model_data(resources);
+  *resources = (model_resources_t){0};
+}
+
+// takes ownership of the model and overwrites the existing buffers when it
+// has the same vertex and index counts and formats (the pipelines and
+// bindings stay valid), returns false (leaving the resources untouched)
+// otherwise, the texture is updated in place when its size matches (see
+// texture_residency_update)
+static bool update_model_resources(
+  model_resources_t* resources, const model_t model,
+  texture_residency_t* residency) {
+  const mesh_buffers_t* current = &resources->model.buffers;
+  const bool same_layout =
+    model.buffers.vertex_count == current->vertex_count
+    && model.buffers.index_count == current->index_count
+    && model.buffers.index_size == current->index_size
+    && (model.buffers.quantized.positions != NULL)
+         == (current->quantized.positions != NULL);
+  if (!same_layout) {
+    return false;
+  }
+  release_model_data(resources);
+  resources->model = model;
+  prepare_model_data(resources);
+  upload_model_data(resources);
+  texture_residency_update(
+    residency, resources->texture_id, &resources->model.texture);
+  release_texture_pixels(&resources->model.texture);
+  return true;
+}
+
+static double elapsed_ms(const uint64_t begin_counter) {
+  return (double)(SDL_GetPerformanceCounter() - begin_counter) * 1000.0
+       / (double)SDL_GetPerformanceFrequency();
+}
+
+// cpu cost of keeping the projected streams up to date, summed over frames
+typedef struct projection_stats_t {
+  int frame_count; // in projected mode
+  int update_count; // frames that reprojected
+  int depth_update_count; // of those, the frames that rewrote the depths
+  double project_ms;
+  double upload_ms;
+  size_t upload_size;
+  int job_count; // of the last update
+} projection_stats_t;
+
+// reprojects the model through the pinned camera into the streams of the
+// active vertex layout and updates their stream buffers in place (the split
+// streams are only needed until then and live in frame_scratch), the depth
+// reciprocals are rewritten only when depths_changed (the split depth
+// buffer keeps its contents otherwise), the vertices are split across the
+// threads of pool, at most once per frame, the cost is added to stats
+static void reproject_model(
+  model_resources_t* resources, const as_mat34f* model,
+  const as_mat34f* view, const as_mat44f* projection,
+  const bool depths_changed, job_pool_t* pool, arena_t* frame_scratch,
+  projection_stats_t* stats) {
+  const mesh_buffers_t* buffers = &resources->model.buffers;
+  const vertex_stream_t* projected_streams = resources->projected_streams;
+  const uint64_t projection_begin_counter = SDL_GetPerformanceCounter();
+  const vertex_projection_t vertex_projection =
+    make_vertex_projection(model, view, projection);
+  const bool half_depth_recips =
+    resources->depth_recip_format == SG_VERTEXFORMAT_HALF2;
+  int job_count;
+  uint64_t upload_begin_counter;
+  size_t upload_size;
+  if (g_vertex_layout == vertex_layout_interleaved) {
+    // the interleaved stream is kept, unchanged depths stay in it
+    uint8_t* vertices = resources->projected_interleaved_vertices;
+    job_count = project_position_blocks_parallel(
+      &resources->position_blocks, &vertex_projection, pool, vertices,
+      resources->projected_vertex_stride,
+      depths_changed
+        ? vertices + projected_streams[0].size + projected_streams[1].size
+        : NULL,
+      resources->projected_vertex_stride, half_depth_recips);
+
+    upload_begin_counter = SDL_GetPerformanceCounter();
+    upload_size = array_length(vertices);
+    sg_update_buffer(
+      resources->projected_interleaved_buffer,
+      &(sg_range){.ptr = vertices, .size = upload_size});
+  } else {
+    const size_t projected_vertices_size =
+      (size_t)buffers->vertex_count * projected_streams[0].size;
+    const size_t depth_recips_size =
+      depths_changed ? (size_t)buffers->vertex_count * projected_streams[2].size
+                     : 0;
+    uint8_t* projected_vertices =
+      arena_alloc(frame_scratch, projected_vertices_size);
+    uint8_t* depth_recips =
+      depths_changed ? arena_alloc(frame_scratch, depth_recips_size) : NULL;
+    job_count = project_position_blocks_parallel(
+      &resources->position_blocks, &vertex_projection, pool,
+      projected_vertices, projected_streams[0].size, depth_recips,
+      projected_streams[2].size, half_depth_recips);
+
+    upload_begin_counter = SDL_GetPerformanceCounter();
+    upload_size = projected_vertices_size + depth_recips_size;
+    sg_update_buffer(
+      resources->projected_vertex_buffer,
+      &(sg_range){.ptr = projected_vertices, .size = projected_vertices_size});
+    if (depths_changed) {
+      sg_update_buffer(
+        resources->depth_recip_buffer,
+        &(sg_range){.ptr = depth_recips, .size = depth_recips_size});
+    }
+  }
+  stats->update_count++;
+  stats->depth_update_count += depths_changed ? 1 : 0;
+  stats->project_ms +=
+    (double)(upload_begin_counter - projection_begin_counter) * 1000.0
+    / (double)SDL_GetPerformanceFrequency();
+  stats->upload_ms += elapsed_ms(upload_begin_counter);
+  stats->upload_size += upload_size;
+  stats->job_count = job_count;
+}
+
 int main(int argc, char** argv) {
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
     return 1;
   }
 
+  // time to the first frame and to the first frame with the model are
+  // reported from here
+  const uint64_t start_counter = SDL_GetPerformanceCounter();
+
   const int width = 1024;
   const int height = 768;
   SDL_Window* window = SDL_CreateWindow(
@@ -108,34 +791,46 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  model_t model = load_obj_mesh_with_png_texture(
-    "assets/models/f22.obj", "assets/textures/f22.png");
-
-  // setup model data
-  float* model_vertices = NULL;
-  float* model_uvs = NULL;
-  uint16_t* model_indices = NULL;
-  uint16_t index = 0;
-  const int face_count = array_length(model.mesh.faces);
-  for (int f = 0; f < face_count; f++) {
-    for (int v = 0; v < 3; v++) {
-      const int vertex_index = model.mesh.faces[f].vert_indices[v] - 1;
-      array_push(model_vertices, model.mesh.vertices[vertex_index].x);
-      array_push(model_vertices, model.mesh.vertices[vertex_index].y);
-      array_push(model_vertices, model.mesh.vertices[vertex_index].z);
-
-      const int uv_index = model.mesh.faces[f].uv_indices[v] - 1;
-      array_push(model_uvs, model.mesh.uvs[uv_index].u);
-      array_push(model_uvs, 1.0f - model.mesh.uvs[uv_index].v);
-
-      array_push(model_indices, index);
-      index++;
-    }
-  }
-
-  array_free(model.mesh.vertices);
-  array_free(model.mesh.uvs);
-  array_free(model.mesh.faces);
+  // a batch holds its pool until it completes, projecting on the render
+  // thread uses a pool of its own so frames never wait behind imports, the
+  // cores are split between the two (each count includes the calling
+  // thread) so together they don't oversubscribe the cpu
+  const int cpu_count = SDL_GetCPUCount();
+  const int projection_thread_count = cpu_count > 1 ? cpu_count / 2 : 1;
+  const int job_thread_count =
+    cpu_count > projection_thread_count ? cpu_count - projection_thread_count
+                                        : 1;
+  job_pool_t* job_pool = job_pool_create(job_thread_count);
+  job_pool_t* projection_pool = job_pool_create(projection_thread_count);
+
+  // set split_16bit_submeshes to keep 16-bit indices for large meshes
+  const mesh_import_options_t mesh_import_options = {
+    .optimize_vertex_cache = true,
+    .quantize_vertices = true,
+    .lod_count = 5,
+    .build_meshlets = true};
+  // the model loads in the background (using the job pool) while frames
+  // with a placeholder are rendered, several requests would load in
+  // parallel on up to asset_thread_count threads
+  const model_request_t model_request = {
+    .mesh_path = "assets/models/f22.obj",
+    .texture_path = "assets/textures/f22.png",
+    .texture_options = {.block_compress = true, .cpu_sampled = false}};
+  const int asset_thread_count = 4;
+  asset_loader_t* asset_loader = asset_loader_create(
+    &model_request, 1, &mesh_import_options, job_pool, asset_thread_count);
+
+  // re-exported assets are re-imported in the background and swapped in
+  const char* const watched_asset_paths[] = {
+    model_request.mesh_path, model_request.texture_path};
+  file_watcher_t* asset_watcher = file_watcher_create(watched_asset_paths, 2);
+  asset_loader_t* reload_loader = NULL;
+  // an export usually writes several times (and both files), a reload
+  // starts once no write was seen for this long
+  const double reload_settle_ms = 100.0;
+  uint64_t first_change_counter = 0; // 0 when no change is pending
+  uint64_t last_change_counter = 0;
+  uint64_t reload_change_counter = 0; // first change of the running reload
 
   // setup sokol_gfx
   const sg_desc desc = se_create_desc();
@@ -144,7 +839,8 @@ int main(int argc, char** argv) {
 
   se_init_imgui(window);
 
-  g_model_transform = as_mat34f_translation_from_vec3f((as_vec3f){.z = 5.0f});
+  const as_vec3f model_position = (as_vec3f){.z = 5.0f};
+  g_model_transform = as_mat34f_translation_from_vec3f(model_position);
 
   float fov_degrees = 60.0f;
   float near_plane = 2.0f;
@@ -155,14 +851,6 @@ int main(int argc, char** argv) {
       (float)width / (float)height, as_radians_from_degrees(60.0f), 0.01f,
       100.0f);
 
-  float* projected_vertices = NULL;
-  projected_vertices =
-    array_hold(projected_vertices, array_length(model_vertices), sizeof(float));
-
-  float* vertex_depth_recips = NULL;
-  vertex_depth_recips = array_hold(
-    vertex_depth_recips, array_length(model_vertices) / 3, sizeof(float));
-
   // clang-format off
   const int cube_line_indices_count = 24;
   const int axes_line_indices_count = 6;
@@ -204,80 +892,53 @@ int main(int argc, char** argv) {
   float lines[sizeof(unit_lines) / sizeof(float)];
   memcpy(&lines, unit_lines, sizeof(lines));
 
-  sg_buffer line_buffer =
-    sg_make_buffer(&(sg_buffer_desc){.data = SG_RANGE(lines)});
+  // rewritten when the view changes (lines_changed), updated in place
+  sg_buffer line_buffer = sg_make_buffer(
+    &(sg_buffer_desc){.usage = SG_USAGE_STREAM, .size = sizeof(lines)});
+  bool lines_changed = true;
   sg_buffer line_color_buffer =
     sg_make_buffer(&(sg_buffer_desc){.data = SG_RANGE(line_colors)});
   sg_buffer line_index_buffer = sg_make_buffer(&(sg_buffer_desc){
     .type = SG_BUFFERTYPE_INDEXBUFFER, .data = SG_RANGE(line_indices)});
 
-  sg_buffer standard_vertex_buffer = sg_make_buffer(&(sg_buffer_desc){
-    .data = (sg_range){
-      .ptr = model_vertices,
-      .size = array_length(model_vertices) * sizeof(float)}});
-  sg_buffer projected_vertex_buffer = sg_make_buffer(&(sg_buffer_desc){
-    .data = (sg_range){
-      .ptr = projected_vertices,
-      .size = array_length(projected_vertices) * sizeof(float)}});
-  sg_buffer uv_buffer = sg_make_buffer(&(sg_buffer_desc){
-    .data = (sg_range){
-      .ptr = model_uvs, .size = array_length(model_uvs) * sizeof(float)}});
-  sg_buffer vertex_depth_recip_buffer = sg_make_buffer(&(sg_buffer_desc){
-    .data = (sg_range){
-      .ptr = vertex_depth_recips,
-      .size = array_length(vertex_depth_recips) * sizeof(float)}});
-  sg_buffer index_buffer = sg_make_buffer(&(sg_buffer_desc){
-    .type = SG_BUFFERTYPE_INDEXBUFFER,
-    .data = (sg_range){
-      .ptr = model_indices,
-      .size = array_length(model_indices) * sizeof(uint16_t)}});
-
   typedef struct vs_params_t {
     as_mat44f mvp;
   } vs_params_t;
 
+  // uniforms of projected_morph_vs (see shader/projected.glsl)
+  typedef struct morph_vs_params_t {
+    as_mat44f mvp;
+    as_mat44f model;
+    as_mat44f pinned_view_projection;
+    float pinned_view_depth[4];
+    float morph[4];
+  } morph_vs_params_t;
+
   const sg_shader shader_projected =
     sg_make_shader(projected_shader_desc(sg_query_backend()));
+  const sg_shader shader_projected_morph =
+    sg_make_shader(projected_morph_shader_desc(sg_query_backend()));
   const sg_shader shader_standard =
     sg_make_shader(standard_shader_desc(sg_query_backend()));
   const sg_shader shader_line =
     sg_make_shader(line_shader_desc(sg_query_backend()));
 
-  const sg_pipeline_desc pip_projected_desc = (sg_pipeline_desc){
-    .shader = shader_projected,
-    .layout =
-      {.attrs =
-         {[0] = {.format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0},
-          [1] = {.format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1},
-          [2] = {.format = SG_VERTEXFORMAT_FLOAT, .buffer_index = 2}}},
-    .index_type = SG_INDEXTYPE_UINT16,
-    .depth =
-      {
-        .compare = SG_COMPAREFUNC_LESS_EQUAL,
-        .write_enabled = true,
-      },
-    .cull_mode = SG_CULLMODE_BACK,
-    .face_winding = SG_FACEWINDING_CW};
-
-  const sg_pipeline pip_projected = sg_make_pipeline(&pip_projected_desc);
+  const model_shaders_t model_shaders = {
+    .standard = shader_standard,
+    .projected = shader_projected,
+    .projected_morph = shader_projected_morph};
 
-  const sg_pipeline_desc pip_standard_desc = (sg_pipeline_desc){
-    .shader = shader_standard,
-    .layout =
-      {.attrs =
-         {[0] = {.format = SG_VERTEXFORMAT_FLOAT3, .buffer_index = 0},
-          [1] = {.format = SG_VERTEXFORMAT_FLOAT2, .buffer_index = 1}}},
-    .index_type = SG_INDEXTYPE_UINT16,
-    .depth =
-      {
-        .compare = SG_COMPAREFUNC_LESS_EQUAL,
-        .write_enabled = true,
-      },
-    .cull_mode = SG_CULLMODE_BACK,
-    .face_winding = SG_FACEWINDING_CW};
+  // decoded pixels are dropped once uploaded unless textures are cpu
+  // sampled (see model_request), gpu images are kept within the budget
+  // (least recently used ones are evicted)
+  int texture_budget_mb = 256;
+  texture_residency_t* texture_residency =
+    texture_residency_create((size_t)texture_budget_mb * 1024 * 1024);
 
-  const sg_pipeline pip_standard = sg_make_pipeline(&pip_standard_desc);
-  const sg_pipeline pip_projected_affine = sg_make_pipeline(&pip_standard_desc);
+  // cpu data only needed until the end of the frame (such as meshlet
+  // visibility and the split projected streams), reset after sg_commit
+  arena_t frame_scratch = arena_create(64 * 1024);
+  size_t frame_scratch_used = 0; // by the previous frame
 
   const sg_pipeline pip_line = sg_make_pipeline(&(sg_pipeline_desc){
     .shader = shader_line,
@@ -293,42 +954,19 @@ int main(int argc, char** argv) {
       },
     .primitive_type = SG_PRIMITIVETYPE_LINES});
 
-  sg_image model_image = sg_make_image(&(sg_image_desc){
-    .width = model.texture.width,
-    .height = model.texture.height,
-    .data.subimage[0][0] =
-      (sg_range){
-        .ptr = model.texture.color_buffer,
-        .size = model.texture.width * model.texture.height * sizeof(uint32_t)},
-    .label = "model-texture"});
-
-  // resource bindings
-  sg_bindings bind_projected = {
-    .vertex_buffers =
-      {[0] = projected_vertex_buffer,
-       [1] = uv_buffer,
-       [2] = vertex_depth_recip_buffer},
-    .vertex_buffer_offsets = {[0] = 0, [1] = 0, [2] = 0},
-    .index_buffer = index_buffer,
-    .fs_images[0] = model_image};
-
-  sg_bindings bind_projected_affine = {
-    .vertex_buffers = {[0] = projected_vertex_buffer, [1] = uv_buffer},
-    .vertex_buffer_offsets = {[0] = 0, [1] = 0},
-    .index_buffer = index_buffer,
-    .fs_images[0] = model_image};
-
-  sg_bindings bind_standard = {
-    .vertex_buffers = {[0] = standard_vertex_buffer, [1] = uv_buffer},
-    .vertex_buffer_offsets = {[0] = 0, [1] = 0},
-    .index_buffer = index_buffer,
-    .fs_images[0] = model_image};
-
   sg_bindings bind_line = {
     .vertex_buffers = {[0] = line_buffer, [1] = line_color_buffer},
     .vertex_buffer_offsets = {[0] = 0, [1] = 0},
     .index_buffer = line_index_buffer};
 
+  // the unit cube drawn where the model will be until it has loaded
+  sg_buffer placeholder_line_buffer =
+    sg_make_buffer(&(sg_buffer_desc){.data = SG_RANGE(unit_lines)});
+  sg_bindings bind_placeholder = {
+    .vertex_buffers = {[0] = placeholder_line_buffer, [1] = line_color_buffer},
+    .vertex_buffer_offsets = {[0] = 0, [1] = 0},
+    .index_buffer = line_index_buffer};
+
   // default pass action (clear to grey)
   sg_pass_action pass_action = {0};
 
@@ -347,15 +985,55 @@ int main(int argc, char** argv) {
     .near_plane = near_plane};
 
   bool pin_camera = false;
+  // in projected mode the movement keys and mouse move the pinned camera
+  // (instead of looking at the projection)
+  bool move_pinned_camera = false;
+  bool animate_model = false;
+  float model_angle = 0.0f; // turned about the y axis when animated
   bool draw_axes = false;
+  int forced_lod = -1; // automatic
+  float lod_pixel_error = 1.0f;
+  bool cull_meshlets = true;
+  // meshlet culling results summed over the frames of the current second,
+  // then printed (so the gain is visible without the ui)
+  meshlet_cull_stats_t meshlet_stats_sum = {0};
+  meshlet_cull_stats_t meshlet_stats = {0};
+  int meshlet_draw_count_sum = 0;
+  int meshlet_draw_count = 0;
+  int meshlet_stats_frame_count = 0;
+  // the same for reprojection, shown for the previous second
+  projection_stats_t projection_stats_sum = {0};
+  projection_stats_t projection_stats = {0};
+  uint64_t stats_begin_counter = SDL_GetPerformanceCounter();
+  // what the projected streams were last written with, compared every frame
+  // so only changes reproject (and only the streams a change affects are
+  // uploaded), invalid until written and after anything replaces them
+  typedef struct projected_inputs_t {
+    as_mat34f model;
+    as_mat34f view; // of the pinned camera
+    as_mat44f projection;
+  } projected_inputs_t;
+  projected_inputs_t projected_inputs = {0};
+  bool projected_inputs_valid = false;
+  // filled in once the asset loader hands the model over
+  model_resources_t model_resources = {0};
+  const mesh_buffers_t* model_buffers = &model_resources.model.buffers;
+  bool model_ready = false;
+  bool first_frame_presented = false;
   vs_params_t vs_params_model;
   vs_params_t vs_params_lines;
+  morph_vs_params_t vs_params_morph = {0};
+  bool animate_morph = false;
+  double morph_time = 0.0; // seconds animated
   uint64_t previous_counter = 0;
   for (bool quit = false; !quit;) {
     const uint64_t current_counter = SDL_GetPerformanceCounter();
     const double delta_time = (double)(current_counter - previous_counter)
                             / (double)SDL_GetPerformanceFrequency();
     previous_counter = current_counter;
+    camera_t* controlled_camera = g_mode == mode_projected && move_pinned_camera
+                                  ? &projected_camera
+                                  : &g_camera;
     for (SDL_Event current_event; SDL_PollEvent(&current_event) != 0;) {
       ImGui_ImplSDL2_ProcessEvent(&current_event);
       if (igGetIO()->WantCaptureMouse) {
@@ -374,8 +1052,8 @@ int main(int argc, char** argv) {
           if (g_mouse_down) {
             const as_vec2i mouse_delta =
               as_point2i_sub_point2i(g_mouse_position, previous_mouse_position);
-            g_camera.pitch += (float)mouse_delta.y * 0.005f;
-            g_camera.yaw += (float)mouse_delta.x * 0.005f;
+            controlled_camera->pitch += (float)mouse_delta.y * 0.005f;
+            controlled_camera->yaw += (float)mouse_delta.x * 0.005f;
           }
         } break;
         case SDL_MOUSEBUTTONDOWN: {
@@ -421,7 +1099,80 @@ int main(int argc, char** argv) {
       }
     }
 
-    update_movement((float)delta_time);
+    update_movement(controlled_camera, (float)delta_time);
+    // the pin moves with the pinned camera (the frustum lines and the return
+    // to standard mode use it)
+    if (controlled_camera == &projected_camera) {
+      pinned_camera_state.camera = projected_camera;
+    }
+    texture_residency_begin_frame(texture_residency);
+
+    // gpu resources are created on the frame the model arrives
+    bool model_arrived = false;
+    loaded_model_t loaded_model;
+    if (!model_ready && asset_loader_poll(asset_loader, &loaded_model)) {
+      const uint64_t create_begin_counter = SDL_GetPerformanceCounter();
+      model_resources = create_model_resources(
+        loaded_model.model, &model_shaders, texture_residency,
+        &model_request);
+      model_ready = true;
+      model_arrived = true;
+      printf(
+        "Model loaded in %.2fms (loader thread), gpu resources created in "
+        "%.2fms\n",
+        loaded_model.load_ms, elapsed_ms(create_begin_counter));
+    }
+
+    bool changed_assets[2];
+    if (file_watcher_poll(asset_watcher, changed_assets) > 0 && model_ready) {
+      last_change_counter = SDL_GetPerformanceCounter();
+      if (first_change_counter == 0) {
+        first_change_counter = last_change_counter;
+      }
+    }
+    // changes seen during a reload start another one once it's done
+    if (
+      reload_loader == NULL && first_change_counter != 0
+      && elapsed_ms(last_change_counter) >= reload_settle_ms) {
+      reload_loader = asset_loader_create(
+        &model_request, 1, &mesh_import_options, job_pool, 1);
+      reload_change_counter = first_change_counter;
+      first_change_counter = 0;
+    }
+    bool model_reloaded = false;
+    if (
+      reload_loader != NULL
+      && asset_loader_poll(reload_loader, &loaded_model)) {
+      asset_loader_destroy(reload_loader);
+      reload_loader = NULL;
+      model_t* reloaded = &loaded_model.model;
+      if (
+        reloaded->buffers.vertex_count == 0
+        || reloaded->texture.width == 0) {
+        // most likely caught the file half written, the next write reloads
+        printf(
+          "Failed to reload %s, keeping the current model\n",
+          model_request.mesh_path);
+        free_mesh_buffers(&reloaded->buffers);
+        free_texture(&reloaded->texture);
+      } else {
+        const uint64_t update_begin_counter = SDL_GetPerformanceCounter();
+        const bool updated_in_place = update_model_resources(
+          &model_resources, *reloaded, texture_residency);
+        if (!updated_in_place) {
+          destroy_model_resources(&model_resources, texture_residency);
+          model_resources = create_model_resources(
+            *reloaded, &model_shaders, texture_residency, &model_request);
+        }
+        model_reloaded = true;
+        printf(
+          "Reloaded %s %.2fms after the change (import %.2fms, gpu resources "
+          "%s in %.2fms)\n",
+          model_request.mesh_path, elapsed_ms(reload_change_counter),
+          loaded_model.load_ms, updated_in_place ? "updated" : "recreated",
+          elapsed_ms(update_begin_counter));
+      }
+    }
 
     ImGui_ImplSDL2_NewFrame();
     simgui_new_frame(&(simgui_frame_desc_t){
@@ -476,18 +1227,192 @@ int main(int argc, char** argv) {
       igEndDisabled();
     }
 
+    if (g_mode != mode_projected) {
+      igBeginDisabled(true);
+    }
+    igCheckbox("Move pinned camera", &move_pinned_camera);
+    if (g_mode != mode_projected) {
+      igEndDisabled();
+    }
+
     igCheckbox("Draw axes", &draw_axes);
+    igCheckbox("Animate model", &animate_model);
+    if (animate_model) {
+      model_angle += (float)delta_time * 0.5f;
+      g_model_transform = as_mat34f_mul_mat33f_v(
+        as_mat34f_translation_from_vec3f(model_position),
+        as_mat33f_y_axis_rotation(model_angle));
+    }
+
+    const vertex_layout_e prev_vertex_layout = g_vertex_layout;
+    int vertex_layout_index = (int)g_vertex_layout;
+    const char* vertex_layout_names[] = {"Split", "Interleaved"};
+    igCombo_Str_arr(
+      "Vertex layout", &vertex_layout_index, vertex_layout_names, 2, 2);
+    g_vertex_layout = (vertex_layout_e)vertex_layout_index;
+    // only the stream of the active layout is kept up to date
+    const bool vertex_layout_changed = g_vertex_layout != prev_vertex_layout;
+
+    // the projected vertices are seen through the pinned camera
+    const camera_t* lod_camera =
+      g_mode == mode_projected ? &projected_camera : &g_camera;
+    const float lod_fov_degrees = g_mode == mode_projected
+                                  ? pinned_camera_state.fov_degrees
+                                  : fov_degrees;
+    const as_point3f model_world_center =
+      as_mat34f_mul_point3f(&g_model_transform, model_resources.center);
+    const float model_distance =
+      as_vec3f_length(as_point3f_sub_point3f(
+        camera_position(lod_camera), model_world_center))
+      - model_resources.radius;
+    const float model_pixels_per_unit = pixels_per_unit(
+      model_distance, as_radians_from_degrees(lod_fov_degrees),
+      (float)height);
+    // a reloaded model may have fewer lods (automatic while none are loaded)
+    if (forced_lod >= model_buffers->lod_count) {
+      forced_lod = model_buffers->lod_count - 1;
+    }
+    const int lod = forced_lod >= 0
+                    ? forced_lod
+                    : select_lod(
+                      model_buffers, model_pixels_per_unit, lod_pixel_error);
+
+    if (!model_ready) {
+      igText("Loading %s...", model_request.mesh_path);
+    }
+
+    if (igCollapsingHeader_TreeNodeFlags("Level of detail", 0)) {
+      igSliderInt(
+        "LOD", &forced_lod, -1, model_buffers->lod_count - 1,
+        forced_lod < 0 ? "Automatic" : "%d", 0);
+      igSliderFloat(
+        "Max pixel error", &lod_pixel_error, 0.1f, 16.0f, "%.1f", 0);
+      igText(
+        "Model size: %.0f pixels",
+        2.0f * model_resources.radius * model_pixels_per_unit);
+      for (int l = 0; l < model_buffers->lod_count; l++) {
+        igText(
+          "%s LOD %d: %d triangles (%.1f pixel error)", l == lod ? ">" : " ",
+          l, model_buffers->lods[l].triangle_count,
+          model_buffers->lods[l].error * model_pixels_per_unit);
+      }
+    }
+
+    // projected vertices may be looked at from anywhere, only the standard
+    // mode culls against the camera
+    const bool meshlets_culled = cull_meshlets && g_mode == mode_standard
+                              && model_buffers->meshlet_count > 0;
+    if (igCollapsingHeader_TreeNodeFlags("Meshlets", 0)) {
+      if (model_buffers->meshlet_count == 0 || g_mode == mode_projected) {
+        igBeginDisabled(true);
+      }
+      igCheckbox("Cull meshlets", &cull_meshlets);
+      if (model_buffers->meshlet_count == 0 || g_mode == mode_projected) {
+        igEndDisabled();
+      }
+      if (meshlets_culled && meshlet_stats.meshlet_count > 0) {
+        const int culled_count = meshlet_stats.frustum_culled_count
+                               + meshlet_stats.backface_culled_count;
+        igText(
+          "%d of %d meshlets drawn with %d draws",
+          meshlet_stats.meshlet_count - culled_count,
+          meshlet_stats.meshlet_count, meshlet_draw_count);
+        igText(
+          "Culled %.1f%% (frustum %.1f%%, backface %.1f%%)",
+          100.0f * culled_count / meshlet_stats.meshlet_count,
+          100.0f * meshlet_stats.frustum_culled_count
+            / meshlet_stats.meshlet_count,
+          100.0f * meshlet_stats.backface_culled_count
+            / meshlet_stats.meshlet_count);
+      }
+    }
+
+    if (igCollapsingHeader_TreeNodeFlags("Textures", 0)) {
+      if (igSliderInt("Budget (MB)", &texture_budget_mb, 1, 1024, "%d", 0)) {
+        texture_residency_set_budget(
+          texture_residency, (size_t)texture_budget_mb * 1024 * 1024);
+      }
+      const texture_residency_stats_t texture_stats =
+        texture_residency_stats(texture_residency);
+      igText(
+        "%d of %d textures resident, %.1f of %.1f MB",
+        texture_stats.resident_count, texture_stats.texture_count,
+        (double)texture_stats.resident_bytes / (1024.0 * 1024.0),
+        (double)texture_stats.budget_bytes / (1024.0 * 1024.0));
+      igText(
+        "%d evicted, %d restored", texture_stats.eviction_count,
+        texture_stats.restore_count);
+      igText(
+        "Decoded pixels %s after upload",
+        model_request.texture_options.cpu_sampled ? "kept (cpu sampled)"
+                                                  : "released");
+    }
+
+    if (igCollapsingHeader_TreeNodeFlags("Projection", 0)) {
+      if (g_mode != mode_projected) {
+        igText("Only in projected mode");
+      } else if (g_project_on_gpu) {
+        igText("Projected in the vertex shader, no cpu cost");
+      } else if (projection_stats.frame_count > 0) {
+        // over the previous second
+        const double frame_count = projection_stats.frame_count;
+        igText(
+          "Reprojected %d of %d frames (%d with depths)",
+          projection_stats.update_count, projection_stats.frame_count,
+          projection_stats.depth_update_count);
+        igText(
+          "Cpu per frame: %.3fms projecting (%d job(s)), %.3fms uploading",
+          projection_stats.project_ms / frame_count, projection_stats.job_count,
+          projection_stats.upload_ms / frame_count);
+        igText(
+          "Uploaded per frame: %.2f MB",
+          (double)projection_stats.upload_size / (1024.0 * 1024.0)
+            / frame_count);
+      }
+    }
+
+    if (igCollapsingHeader_TreeNodeFlags("Memory", 0)) {
+      igText(
+        "Frame scratch: %.1f KB last frame, %.1f KB peak",
+        (double)frame_scratch_used / 1024.0,
+        (double)frame_scratch.peak_used / 1024.0);
+      igText(
+        "%.1f KB reserved, %d block(s) malloc'd since start",
+        (double)frame_scratch.reserved / 1024.0,
+        frame_scratch.block_allocation_count);
+    }
 
     if (g_mode != mode_projected) {
       igBeginDisabled(true);
     }
     igCheckbox("Affine texture mapping", &g_affine);
+    const bool projected_on_gpu = g_project_on_gpu;
+    igCheckbox("Project on gpu", &g_project_on_gpu);
+    if (!g_project_on_gpu) {
+      igBeginDisabled(true);
+    }
+    if (animate_morph && g_project_on_gpu && g_mode == mode_projected) {
+      morph_time += delta_time;
+      g_morph = 0.5f - 0.5f * cosf((float)morph_time);
+    }
+    igSliderFloat("Morph", &g_morph, 0.0f, 1.0f, "%.3f", 0);
+    igCheckbox("Animate morph", &animate_morph);
+    if (!g_project_on_gpu) {
+      igEndDisabled();
+    }
     if (g_mode != mode_projected) {
       igEndDisabled();
     }
+    // the cpu projected streams are stale after projecting on the gpu
+    const bool project_on_gpu_changed = g_project_on_gpu != projected_on_gpu;
+    const bool gpu_projected = g_mode == mode_projected && g_project_on_gpu;
 
     if (!pin_camera) {
-      pinned_camera_state.camera = g_camera;
+      // in projected mode g_camera looks at the projection, the pin stays
+      // put (or follows projected_camera)
+      if (prev_mode == mode_standard) {
+        pinned_camera_state.camera = g_camera;
+      }
       pinned_camera_state.fov_degrees = fov_degrees;
       pinned_camera_state.near_plane = near_plane;
       pinned_camera_state.far_plane = far_plane;
@@ -532,21 +1457,17 @@ int main(int argc, char** argv) {
       }
     }
 
-    if (mode_changed || projection_parameters_changed || pin_camera_changed) {
+    const bool view_changed =
+      mode_changed || projection_parameters_changed || pin_camera_changed;
+    if (view_changed) {
       if (g_mode == mode_standard) {
-        sg_destroy_buffer(line_buffer);
-        line_buffer =
-          sg_make_buffer(&(sg_buffer_desc){.data = SG_RANGE(lines)});
-        bind_line.vertex_buffers[0] = line_buffer;
+        lines_changed = true;
       }
 
       if (g_mode == mode_projected) {
         if (mode_changed) {
           memcpy(&lines, unit_lines, sizeof(lines));
-          sg_destroy_buffer(line_buffer);
-          line_buffer =
-            sg_make_buffer(&(sg_buffer_desc){.data = SG_RANGE(lines)});
-          bind_line.vertex_buffers[0] = line_buffer;
+          lines_changed = true;
 
           projected_camera = pinned_camera_state.camera;
 
@@ -555,54 +1476,6 @@ int main(int argc, char** argv) {
           g_camera.pitch = 0.0f;
           g_camera.yaw = 0.0f;
         }
-
-        sg_destroy_buffer(projected_vertex_buffer);
-        sg_destroy_buffer(vertex_depth_recip_buffer);
-
-        const as_mat44f pinned_perspective_projection =
-          se_perspective_projection(
-            (float)width / (float)height,
-            as_radians_from_degrees(pinned_camera_state.fov_degrees),
-            pinned_camera_state.near_plane, pinned_camera_state.far_plane);
-
-        for (int v = 0; v < array_length(projected_vertices); v += 3) {
-          const as_point3f vertex = (as_point3f){
-            model_vertices[v], model_vertices[v + 1], model_vertices[v + 2]};
-          const as_point3f model_vertex =
-            as_mat34f_mul_point3f_v(g_model_transform, vertex);
-          const as_point3f model_view_vertex = as_mat34f_mul_point3f_v(
-            camera_view(&projected_camera), model_vertex);
-          const as_point4f projected_vertex = as_mat44f_project_point3f(
-            &pinned_perspective_projection, model_view_vertex);
-          projected_vertices[v] = projected_vertex.x;
-          projected_vertices[v + 1] = projected_vertex.y;
-          projected_vertices[v + 2] = projected_vertex.z;
-        }
-
-        projected_vertex_buffer = sg_make_buffer(&(sg_buffer_desc){
-          .data = (sg_range){
-            .ptr = projected_vertices,
-            .size = array_length(projected_vertices) * sizeof(float)}});
-
-        for (int v = 0, d = 0; v < array_length(projected_vertices);
-             v += 3, d++) {
-          const as_point3f vertex = (as_point3f){
-            model_vertices[v], model_vertices[v + 1], model_vertices[v + 2]};
-          const as_point3f model_vertex =
-            as_mat34f_mul_point3f_v(g_model_transform, vertex);
-          const as_point3f model_view_vertex = as_mat34f_mul_point3f_v(
-            camera_view(&projected_camera), model_vertex);
-          vertex_depth_recips[d] = 1.0f / model_view_vertex.z;
-        }
-
-        vertex_depth_recip_buffer = sg_make_buffer(&(sg_buffer_desc){
-          .data = (sg_range){
-            .ptr = vertex_depth_recips,
-            .size = array_length(vertex_depth_recips) * sizeof(float)}});
-
-        bind_projected.vertex_buffers[0] = projected_vertex_buffer;
-        bind_projected.vertex_buffers[2] = vertex_depth_recip_buffer;
-        bind_projected_affine.vertex_buffers[0] = projected_vertex_buffer;
       } else {
         if (mode_changed) {
           g_camera = projected_camera;
@@ -612,9 +1485,67 @@ int main(int argc, char** argv) {
       }
     }
 
-    const as_mat34f model = g_mode == mode_standard
-                            ? g_model_transform
-                            : as_mat34f_translation_from_vec3f((as_vec3f){0});
+    if (lines_changed) {
+      sg_update_buffer(line_buffer, &SG_RANGE(lines));
+      lines_changed = false;
+    }
+
+    const as_mat44f pinned_perspective_projection = se_perspective_projection(
+      (float)width / (float)height,
+      as_radians_from_degrees(pinned_camera_state.fov_degrees),
+      pinned_camera_state.near_plane, pinned_camera_state.far_plane);
+    const as_mat34f projected_view = camera_view(&projected_camera);
+
+    // the projected streams are replaced with the model, only kept up to
+    // date for the active layout and left alone while in standard mode or
+    // projecting on the gpu
+    if (
+      model_arrived || model_reloaded || vertex_layout_changed || mode_changed
+      || project_on_gpu_changed) {
+      projected_inputs_valid = false;
+    }
+    if (g_mode == mode_projected) {
+      projection_stats_sum.frame_count++;
+    }
+    // every frame the model, the pinned camera or its projection changed
+    // (the depths only depend on the first two), nothing when none did
+    if (model_ready && g_mode == mode_projected && !g_project_on_gpu) {
+      const projected_inputs_t inputs = {
+        .model = g_model_transform,
+        .view = projected_view,
+        .projection = pinned_perspective_projection};
+      const bool model_moved =
+        !projected_inputs_valid
+        || memcmp(&inputs.model, &projected_inputs.model, sizeof inputs.model)
+             != 0;
+      const bool pinned_camera_moved =
+        !projected_inputs_valid
+        || memcmp(&inputs.view, &projected_inputs.view, sizeof inputs.view)
+             != 0;
+      const bool projection_changed =
+        !projected_inputs_valid
+        || memcmp(
+             &inputs.projection, &projected_inputs.projection,
+             sizeof inputs.projection)
+             != 0;
+      if (model_moved || pinned_camera_moved || projection_changed) {
+        reproject_model(
+          &model_resources, &inputs.model, &inputs.view, &inputs.projection,
+          model_moved || pinned_camera_moved, projection_pool, &frame_scratch,
+          &projection_stats_sum);
+        projected_inputs = inputs;
+        projected_inputs_valid = true;
+      }
+    }
+
+    // projected vertices are written in full precision, only the standard
+    // mode reads quantized positions
+    const as_mat34f model_dequantize =
+      model_ready ? model_resources.dequantize : as_mat34f_identity();
+    const as_mat34f model =
+      g_mode == mode_standard
+        ? as_mat34f_mul_mat34f_v(g_model_transform, model_dequantize)
+        : as_mat34f_translation_from_vec3f((as_vec3f){0});
     const as_mat44f view = as_mat44f_from_mat34f_v(camera_view(&g_camera));
     const as_mat44f view_model =
       as_mat44f_mul_mat44f_v(view, as_mat44f_from_mat34f(&model));
@@ -636,20 +1567,136 @@ int main(int argc, char** argv) {
         : as_mat44f_mul_mat44f(
           &perspective_projection_projected_mode, &view_model));
 
-    sg_bindings* bind = g_mode == mode_standard ? &bind_standard
-                      : g_mode == mode_projected && g_affine
-                        ? &bind_projected_affine
-                        : &bind_projected;
-    sg_pipeline pip = g_mode == mode_standard ? pip_standard
-                    : g_affine                ? pip_projected_affine
-                                              : pip_projected;
+    if (gpu_projected) {
+      // the projected positions are seen like the lines of the unit cube
+      vs_params_morph.mvp = vs_params_lines.mvp;
+      vs_params_morph.model = as_mat44f_transpose_v(as_mat44f_from_mat34f_v(
+        as_mat34f_mul_mat34f_v(g_model_transform, model_dequantize)));
+      vs_params_morph.pinned_view_projection =
+        as_mat44f_transpose_v(as_mat44f_mul_mat44f_v(
+          pinned_perspective_projection,
+          as_mat44f_from_mat34f(&projected_view)));
+      memcpy(
+        vs_params_morph.pinned_view_depth, &projected_view.elem[8],
+        sizeof vs_params_morph.pinned_view_depth);
+      vs_params_morph.morph[0] = g_morph;
+      vs_params_morph.morph[1] = g_affine ? 0.0f : g_morph;
+    }
+
+    // projecting on the gpu reads the standard streams
+    const bool standard_streams = g_mode == mode_standard || gpu_projected;
+    sg_bindings* bind;
+    sg_pipeline pip;
+    const int* vertex_strides;
+    model_resources_t* resources = &model_resources;
+    if (g_vertex_layout == vertex_layout_interleaved) {
+      bind = standard_streams ? &resources->bind_standard_interleaved
+                              : &resources->bind_projected_interleaved;
+      pip = g_mode == mode_standard ? resources->pip_standard_interleaved
+          : gpu_projected ? resources->pip_projected_morph_interleaved
+          : g_affine      ? resources->pip_projected_affine_interleaved
+                          : resources->pip_projected_interleaved;
+      vertex_strides = standard_streams
+                       ? resources->standard_interleaved_vertex_strides
+                       : resources->projected_interleaved_vertex_strides;
+    } else {
+      bind = standard_streams ? &resources->bind_standard
+           : g_affine         ? &resources->bind_projected_affine
+                              : &resources->bind_projected;
+      pip = g_mode == mode_standard ? resources->pip_standard
+          : gpu_projected           ? resources->pip_projected_morph
+          : g_affine                ? resources->pip_projected_affine
+                                    : resources->pip_projected;
+      vertex_strides = standard_streams
+                       ? resources->standard_split_vertex_strides
+                       : resources->projected_split_vertex_strides;
+    }
+    // an evicted texture is restored before the pass begins
+    const sg_image model_image =
+      model_ready
+        ? texture_residency_use(texture_residency, resources->texture_id)
+        : (sg_image){SG_INVALID_ID};
+    bind->fs_images[0] = model_image;
+
+    // visibility of each meshlet (NULL draws all of them), bounds are in
+    // the space of the float vertices (before dequantizing)
+    bool* meshlet_visible = NULL;
+    if (meshlets_culled) {
+      meshlet_visible = arena_alloc_array(
+        &frame_scratch, model_buffers->meshlet_count, sizeof(bool));
+      const frustum_planes_t planes = build_frustum_planes(
+        (float)width / (float)height, as_radians_from_degrees(fov_degrees),
+        near_plane, far_plane);
+      const as_mat34f camera_view_transform = camera_view(&g_camera);
+      const meshlet_culling_t culling = make_meshlet_culling(
+        &planes, &g_model_transform, &camera_view_transform);
+      meshlet_stats =
+        cull_mesh_meshlets(model_buffers, lod, &culling, meshlet_visible);
+    }
 
     sg_begin_default_pass(&pass_action, width, height);
 
-    sg_apply_pipeline(pip);
-    sg_apply_bindings(bind);
-    sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &SG_RANGE(vs_params_model));
-    sg_draw(0, array_length(model_indices), 1);
+    int model_draw_count = 0;
+    if (model_image.id != SG_INVALID_ID) {
+      sg_apply_pipeline(pip);
+      if (gpu_projected) {
+        sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &SG_RANGE(vs_params_morph));
+      } else {
+        sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &SG_RANGE(vs_params_model));
+      }
+      model_draw_count = draw_mesh_buffers(
+        bind, model_buffers, lod, vertex_strides, meshlet_visible);
+    } else {
+      sg_apply_pipeline(pip_line);
+      sg_apply_bindings(&bind_placeholder);
+      sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &SG_RANGE(vs_params_model));
+      sg_draw(0, cube_line_indices_count, 1);
+    }
+
+    if (meshlets_culled) {
+      meshlet_draw_count = model_draw_count;
+      meshlet_stats_sum.meshlet_count += meshlet_stats.meshlet_count;
+      meshlet_stats_sum.frustum_culled_count +=
+        meshlet_stats.frustum_culled_count;
+      meshlet_stats_sum.backface_culled_count +=
+        meshlet_stats.backface_culled_count;
+      meshlet_draw_count_sum += model_draw_count;
+      meshlet_stats_frame_count++;
+    }
+    if (
+      current_counter - stats_begin_counter >= SDL_GetPerformanceFrequency()) {
+      if (meshlet_stats_sum.meshlet_count > 0) {
+        const int culled_count = meshlet_stats_sum.frustum_culled_count
+                               + meshlet_stats_sum.backface_culled_count;
+        printf(
+          "Meshlets culled: %.1f%% (frustum %.1f%%, backface %.1f%%), "
+          "%.1f draws per frame\n",
+          100.0 * culled_count / meshlet_stats_sum.meshlet_count,
+          100.0 * meshlet_stats_sum.frustum_culled_count
+            / meshlet_stats_sum.meshlet_count,
+          100.0 * meshlet_stats_sum.backface_culled_count
+            / meshlet_stats_sum.meshlet_count,
+          (double)meshlet_draw_count_sum / meshlet_stats_frame_count);
+      }
+      meshlet_stats_sum = (meshlet_cull_stats_t){0};
+      meshlet_draw_count_sum = 0;
+      meshlet_stats_frame_count = 0;
+      if (projection_stats_sum.update_count > 0) {
+        printf(
+          "Reprojected %d of %d frames (%d with depths, %d job(s)), %.3fms "
+          "projecting and %.3fms uploading %.2f MB per frame\n",
+          projection_stats_sum.update_count, projection_stats_sum.frame_count,
+          projection_stats_sum.depth_update_count,
+          projection_stats_sum.job_count,
+          projection_stats_sum.project_ms / projection_stats_sum.frame_count,
+          projection_stats_sum.upload_ms / projection_stats_sum.frame_count,
+          (double)projection_stats_sum.upload_size / (1024.0 * 1024.0)
+            / projection_stats_sum.frame_count);
+      }
+      projection_stats = projection_stats_sum;
+      projection_stats_sum = (projection_stats_t){0};
+      stats_begin_counter = current_counter;
+    }
 
     // only draw unit cube in projected mode
     if (g_mode == mode_projected || pin_camera || draw_axes) {
@@ -668,32 +1715,41 @@ int main(int argc, char** argv) {
 
     sg_end_pass();
     sg_commit();
+    frame_scratch_used = frame_scratch.used;
+    arena_reset(&frame_scratch);
 
     se_present(window);
+
+    if (!first_frame_presented) {
+      printf("Time to first frame: %.2fms\n", elapsed_ms(start_counter));
+      first_frame_presented = true;
+    }
+    if (model_arrived) {
+      printf("Time to full asset: %.2fms\n", elapsed_ms(start_counter));
+    }
   }
 
   sg_destroy_buffer(line_buffer);
   sg_destroy_buffer(line_color_buffer);
   sg_destroy_buffer(line_index_buffer);
-  sg_destroy_buffer(standard_vertex_buffer);
-  sg_destroy_buffer(projected_vertex_buffer);
-  sg_destroy_buffer(uv_buffer);
-  sg_destroy_buffer(vertex_depth_recip_buffer);
-  sg_destroy_buffer(index_buffer);
+  sg_destroy_buffer(placeholder_line_buffer);
   sg_destroy_shader(shader_standard);
   sg_destroy_shader(shader_projected);
+  sg_destroy_shader(shader_projected_morph);
   sg_destroy_shader(shader_line);
   sg_destroy_pipeline(pip_line);
-  sg_destroy_pipeline(pip_standard);
-  sg_destroy_pipeline(pip_projected);
-  sg_destroy_pipeline(pip_projected_affine);
-  sg_destroy_image(model_image);
-
-  array_free(model_vertices);
-  array_free(model_uvs);
-  array_free(model_indices);
 
-  upng_free(model.texture.png_texture);
+  if (model_ready) {
+    destroy_model_resources(&model_resources, texture_residency);
+  }
+  texture_residency_destroy(texture_residency);
+  arena_free(&frame_scratch);
+  asset_loader_destroy(asset_loader);
+  asset_loader_destroy(reload_loader);
+  file_watcher_destroy(asset_watcher);
+
+  job_pool_destroy(projection_pool);
+  job_pool_destroy(job_pool);
 
   simgui_shutdown();
   sg_shutdown();
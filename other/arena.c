@@ -0,0 +1,155 @@
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct arena_block_t {
+  arena_block_t* previous;
+  size_t size; // bytes of data
+  size_t used;
+  char* data; // aligned to ArenaAlignment, follows the block
+};
+
+static arena_block_t* allocate_block(arena_t* arena, const size_t size) {
+  if (size > SIZE_MAX - sizeof(arena_block_t) - ArenaAlignment) {
+    printf("Arena block of %zu bytes overflows\n", size);
+    fflush(stdout);
+    abort();
+  }
+  arena_block_t* block =
+    malloc(sizeof(arena_block_t) + ArenaAlignment - 1 + size);
+  if (block == NULL) {
+    printf("Failed to allocate an arena block of %zu bytes\n", size);
+    fflush(stdout);
+    abort();
+  }
+  const uintptr_t data = (uintptr_t)(block + 1) + ArenaAlignment - 1;
+  *block = (arena_block_t){
+    .size = size, .data = (char*)(data & ~(uintptr_t)(ArenaAlignment - 1))};
+  arena->reserved += size;
+  arena->block_allocation_count++;
+  return block;
+}
+
+static void free_block(arena_t* arena, arena_block_t* block) {
+  if (block != NULL) {
+    arena->reserved -= block->size;
+    free(block);
+  }
+}
+
+// makes a new block of at least size bytes current
+static arena_block_t* push_block(arena_t* arena, const size_t size) {
+  arena_block_t* block = allocate_block(arena, size);
+  block->previous = arena->block;
+  arena->block = block;
+  return block;
+}
+
+arena_t arena_create(const size_t block_size) {
+  return (arena_t){.block_size = block_size};
+}
+
+void* arena_alloc(arena_t* arena, const size_t size) {
+  arena_block_t* block = arena->block;
+  // the block data is aligned, so aligned offsets are aligned addresses
+  size_t offset =
+    block != NULL
+      ? (block->used + ArenaAlignment - 1) & ~(size_t)(ArenaAlignment - 1)
+      : 0;
+  if (block == NULL || offset > block->size || size > block->size - offset) {
+    const size_t block_size =
+      size > arena->block_size ? size : arena->block_size;
+    block = push_block(arena, block_size);
+    offset = 0;
+  }
+  block->used = offset + size;
+  arena->used += size;
+  arena->peak_used = arena->used > arena->peak_used ? arena->used
+                                                    : arena->peak_used;
+  arena->allocation_count++;
+  return block->data + offset;
+}
+
+void* arena_alloc_array(
+  arena_t* arena, const size_t count, const size_t item_size) {
+  if (item_size != 0 && count > SIZE_MAX / item_size) {
+    printf(
+      "Arena array of %zu items of %zu bytes overflows\n", count, item_size);
+    fflush(stdout);
+    abort();
+  }
+  return arena_alloc(arena, count * item_size);
+}
+
+void* arena_calloc(arena_t* arena, const size_t count, const size_t item_size) {
+  void* memory = arena_alloc_array(arena, count, item_size);
+  memset(memory, 0, count * item_size);
+  return memory;
+}
+
+// frees the blocks allocated after last (all of them when NULL)
+static void free_blocks_after(arena_t* arena, arena_block_t* last) {
+  while (arena->block != last) {
+    arena_block_t* block = arena->block;
+    arena->block = block->previous;
+    free_block(arena, block);
+  }
+}
+
+arena_mark_t arena_mark(const arena_t* arena) {
+  return (arena_mark_t){
+    .block = arena->block,
+    .block_used = arena->block != NULL ? arena->block->used : 0,
+    .used = arena->used};
+}
+
+void arena_rewind(arena_t* arena, const arena_mark_t mark) {
+  // the blocks are freed as their pages would stay resident while the task
+  // moves on to memory allocated elsewhere, except for a first block of the
+  // default size that every step reuses
+  while (arena->block != mark.block) {
+    arena_block_t* block = arena->block;
+    if (block->previous == NULL && block->size == arena->block_size) {
+      break;
+    }
+    arena->block = block->previous;
+    free_block(arena, block);
+  }
+  if (arena->block != NULL) {
+    arena->block->used =
+      arena->block == mark.block ? mark.block_used : 0;
+  }
+  arena->used = mark.used;
+}
+
+void arena_reset(arena_t* arena) {
+  if (arena->block != NULL && arena->block->previous != NULL) {
+    // each block's allocations again start aligned in the merged block
+    size_t size = 0;
+    for (const arena_block_t* block = arena->block; block != NULL;
+         block = block->previous) {
+      size += block->used + ArenaAlignment;
+    }
+    free_blocks_after(arena, NULL);
+    arena->block = allocate_block(arena, size);
+  } else if (
+    arena->block != NULL && arena->block->size > arena->block_size
+    && arena->used < arena->block->size / 4) {
+    // mostly unused since the last reset, a one off large allocation should
+    // not stay reserved
+    free_blocks_after(arena, NULL);
+  }
+  if (arena->block != NULL) {
+    arena->block->used = 0;
+  }
+  arena->used = 0;
+  arena->allocation_count = 0;
+}
+
+void arena_free(arena_t* arena) {
+  free_blocks_after(arena, NULL);
+  *arena = (arena_t){.block_size = arena->block_size};
+}
@@ -0,0 +1,49 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// allocations are aligned like array.h items (see ArrayAlignment)
+#define ArenaAlignment 64
+
+typedef struct arena_block_t arena_block_t;
+
+// linear allocator, allocations bump a cursor through malloc'd blocks and
+// are all released at once by arena_reset or arena_free (not thread safe)
+typedef struct arena_t {
+  arena_block_t* block; // current block, linked to the previous ones
+  size_t block_size; // smallest block to allocate
+  size_t used; // bytes handed out since the last reset
+  size_t peak_used; // largest used so far
+  size_t reserved; // bytes held in blocks
+  int allocation_count; // arena_alloc calls since the last reset
+  int block_allocation_count; // blocks malloc'd over the arena lifetime
+} arena_t;
+
+// position to rewind an arena to
+typedef struct arena_mark_t {
+  arena_block_t* block;
+  size_t block_used;
+  size_t used;
+} arena_mark_t;
+
+arena_t arena_create(size_t block_size);
+// the memory is uninitialized, aborts when out of memory
+void* arena_alloc(arena_t* arena, size_t size);
+// count items of item_size bytes, aborts when the size overflows
+void* arena_alloc_array(arena_t* arena, size_t count, size_t item_size);
+// arena_alloc_array cleared to zero
+void* arena_calloc(arena_t* arena, size_t count, size_t item_size);
+arena_mark_t arena_mark(const arena_t* arena);
+// releases the allocations made since mark and frees the blocks they needed
+// beyond the marked one (for temporaries of one step of a longer task), a
+// first block of block_size bytes is kept
+void arena_rewind(arena_t* arena, arena_mark_t mark);
+// releases every allocation, when they spilled over several blocks these
+// are replaced by a single block large enough for all of them, so a
+// workload repeated between resets stops allocating after the first one (a
+// large block mostly unused since the previous reset is freed instead)
+void arena_reset(arena_t* arena);
+void arena_free(arena_t* arena);
+
+#endif // ARENA_H
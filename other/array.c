@@ -2,42 +2,101 @@
 
 #include "array.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#define ARRAY_RAW_DATA(array) ((int*)(array)-2)
-#define ARRAY_CAPACITY(array) (ARRAY_RAW_DATA(array)[0])
-#define ARRAY_OCCUPIED(array) (ARRAY_RAW_DATA(array)[1])
-
-void* array_hold(void* array, const int count, const int item_size) {
-  if (array == NULL) {
-    int raw_size = (sizeof(int) * 2) + (item_size * count);
-    int* base = (int*)malloc(raw_size);
-    base[0] = count; // capacity
-    base[1] = count; // occupied
-    return base + 2;
-  } else if (ARRAY_OCCUPIED(array) + count <= ARRAY_CAPACITY(array)) {
-    ARRAY_OCCUPIED(array) += count;
+// bytes allocated besides the items, room for the header and the alignment
+#define ArrayPadding (sizeof(array_header_t) + ArrayAlignment - 1)
+
+// resizes the allocation to capacity items with realloc (which can grow
+// large arrays in place) and moves the items when the new allocation has a
+// different misalignment, length is clamped to capacity
+static void* reallocate(
+  void* array, const size_t capacity, const size_t length,
+  const size_t item_size) {
+  if (item_size != 0 && capacity > (SIZE_MAX - ArrayPadding) / item_size) {
+    printf("Array of %zu items of %zu bytes overflows\n", capacity, item_size);
+    fflush(stdout);
+    abort();
+  }
+  const size_t old_offset = array != NULL ? array_header(array)->offset : 0;
+  const size_t kept =
+    array_length(array) < capacity ? array_length(array) : capacity;
+  char* base = realloc(
+    array != NULL ? (char*)array - old_offset : NULL,
+    ArrayPadding + capacity * item_size);
+  if (base == NULL) {
+    printf(
+      "Failed to allocate an array of %zu items of %zu bytes\n", capacity,
+      item_size);
+    fflush(stdout);
+    abort();
+  }
+  const uintptr_t items_address =
+    ((uintptr_t)base + ArrayPadding) & ~(uintptr_t)(ArrayAlignment - 1);
+  char* items = (char*)items_address;
+  const size_t offset = (size_t)(items - base);
+  if (array != NULL && offset != old_offset) {
+    memmove(items, base + old_offset, kept * item_size);
+  }
+  *array_header(items) = (array_header_t){
+    .capacity = capacity,
+    .length = length < capacity ? length : capacity,
+    .offset = offset};
+  return items;
+}
+
+static size_t grown_length(const void* array, const size_t count) {
+  if (count > SIZE_MAX - array_length(array)) {
+    printf(
+      "Array of %zu items overflows when adding %zu\n", array_length(array),
+      count);
+    fflush(stdout);
+    abort();
+  }
+  return array_length(array) + count;
+}
+
+void* array_grow(void* array, const size_t count, const size_t item_size) {
+  const size_t length = grown_length(array, count);
+  if (array != NULL && length <= array_capacity(array)) {
     return array;
-  } else {
-    int needed_size = ARRAY_OCCUPIED(array) + count;
-    int float_curr = ARRAY_CAPACITY(array) * 2;
-    int capacity = needed_size > float_curr ? needed_size : float_curr;
-    int occupied = needed_size;
-    int raw_size = sizeof(int) * 2 + item_size * capacity;
-    int* base = (int*)realloc(ARRAY_RAW_DATA(array), raw_size);
-    base[0] = capacity;
-    base[1] = occupied;
-    return base + 2;
   }
+  // doubling stops at the largest capacity reallocate accepts
+  const size_t largest =
+    item_size != 0 ? (SIZE_MAX - ArrayPadding) / item_size : SIZE_MAX;
+  const size_t capacity = array_capacity(array);
+  const size_t doubled = capacity > largest / 2 ? largest : capacity * 2;
+  return reallocate(
+    array, length > doubled ? length : doubled, array_length(array),
+    item_size);
 }
 
-int array_length(void* array) {
-  return (array != NULL) ? (ARRAY_OCCUPIED(array)) : 0;
+void* array_hold(void* array, const size_t count, const size_t item_size) {
+  array = array_grow(array, count, item_size);
+  array_header(array)->length += count;
+  return array;
+}
+
+void* array_reserve(
+  void* array, const size_t capacity, const size_t item_size) {
+  if (array != NULL && capacity <= array_capacity(array)) {
+    return array;
+  }
+  return reallocate(array, capacity, array_length(array), item_size);
+}
+
+void* array_shrink(void* array, const size_t count, const size_t item_size) {
+  if (array == NULL || count >= array_length(array)) {
+    return array;
+  }
+  return reallocate(array, count, count, item_size);
 }
 
 void array_free(void* array) {
   if (array != NULL) {
-    free(ARRAY_RAW_DATA(array));
+    free((char*)array - array_header(array)->offset);
   }
 }
@@ -3,14 +3,66 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 
+#include <stddef.h>
+#include <string.h>
+
+// items start on a cache line boundary, so arrays can be read with aligned
+// 128, 256 and 512 bit loads
+#define ArrayAlignment 64
+
+// stored right in front of the items, offset is the distance from the start
+// of the allocation to the items
+typedef struct array_header_t {
+  size_t capacity;
+  size_t length;
+  size_t offset;
+} array_header_t;
+
+#define array_header(array) ((array_header_t*)(array)-1)
+
+// appends value, only calling into array.c when the capacity is used up
 #define array_push(array, value)                                               \
   do {                                                                         \
-    (array) = array_hold((array), 1, sizeof(*(array)));                        \
-    (array)[array_length(array) - 1] = (value);                                \
+    if (array_length(array) == array_capacity(array)) {                        \
+      (array) = array_grow((array), 1, sizeof(*(array)));                      \
+    }                                                                          \
+    (array)[array_header(array)->length++] = (value);                          \
   } while (0);
 
-void* array_hold(void* array, int count, int item_size);
-int array_length(void* array);
+// appends count items copied from items
+#define array_extend(array, items, count)                                      \
+  ((array) = array_push_n((array), (items), (count), sizeof(*(array))))
+
+// makes room for count more items without changing the length, a new array
+// gets exactly count items of capacity, a full one at least doubles it
+void* array_grow(void* array, size_t count, size_t item_size);
+// grows the length by count items (left uninitialized)
+void* array_hold(void* array, size_t count, size_t item_size);
+// makes room for at least capacity items without changing the length
+void* array_reserve(void* array, size_t capacity, size_t item_size);
+// truncates the array to count items and releases the unused capacity
+void* array_shrink(void* array, size_t count, size_t item_size);
 void array_free(void* array);
 
+static inline size_t array_length(const void* array) {
+  return array != NULL ? array_header(array)->length : 0;
+}
+
+static inline size_t array_capacity(const void* array) {
+  return array != NULL ? array_header(array)->capacity : 0;
+}
+
+static inline void* array_push_n(
+  void* array, const void* items, const size_t count, const size_t item_size) {
+  if (count > array_capacity(array) - array_length(array)) {
+    array = array_grow(array, count, item_size);
+  }
+  if (count > 0) {
+    array_header_t* header = array_header(array);
+    memcpy((char*)array + header->length * item_size, items, count * item_size);
+    header->length += count;
+  }
+  return array;
+}
+
 #endif // ARRAY_H
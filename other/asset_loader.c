@@ -0,0 +1,163 @@
+#include "asset_loader.h"
+
+#include "spsc_queue.h"
+
+#include <SDL.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct loader_worker_t {
+  asset_loader_t* loader;
+  SDL_Thread* thread;
+  spsc_queue_t* loaded_models; // loaded_model_t* from this worker only
+} loader_worker_t;
+
+struct asset_loader_t {
+  loader_worker_t* workers;
+  int worker_count;
+  const model_request_t* requests; // copy owned by the loader
+  int request_count;
+  mesh_import_options_t options;
+  job_pool_t* pool;
+  SDL_atomic_t next_request; // claimed by the workers in order
+  SDL_atomic_t cancel;
+  // consumer only
+  int polled_count;
+  int next_polled_worker;
+  uint64_t begin_counter;
+  double slowest_load_ms;
+  double total_load_ms;
+};
+
+static double elapsed_ms(const uint64_t begin_counter) {
+  return (double)(SDL_GetPerformanceCounter() - begin_counter) * 1000.0
+       / (double)SDL_GetPerformanceFrequency();
+}
+
+static void release_model(model_t* model) {
+  free_mesh_buffers(&model->buffers);
+  free_texture(&model->texture);
+}
+
+static int worker_main(void* data) {
+  loader_worker_t* worker = data;
+  asset_loader_t* loader = worker->loader;
+  while (SDL_AtomicGet(&loader->cancel) == 0) {
+    const int r = SDL_AtomicAdd(&loader->next_request, 1);
+    if (r >= loader->request_count) {
+      break;
+    }
+    const uint64_t begin_counter = SDL_GetPerformanceCounter();
+    const model_request_t* request = &loader->requests[r];
+    loaded_model_t* loaded = malloc(sizeof(loaded_model_t));
+    loaded->model = load_obj_mesh_with_png_texture(
+      request->mesh_path, request->texture_path, &loader->options,
+      &request->texture_options, loader->pool);
+    loaded->request_index = r;
+    loaded->load_ms = elapsed_ms(begin_counter);
+    // each queue holds every request so this never fails
+    spsc_queue_push(worker->loaded_models, loaded);
+  }
+  return 0;
+}
+
+asset_loader_t* asset_loader_create(
+  const model_request_t* requests, const int request_count,
+  const mesh_import_options_t* options, job_pool_t* pool,
+  const int thread_count) {
+  asset_loader_t* loader = calloc(1, sizeof(asset_loader_t));
+  model_request_t* requests_copy =
+    malloc((size_t)request_count * sizeof(model_request_t));
+  for (int r = 0; r < request_count; r++) {
+    requests_copy[r] = requests[r];
+  }
+  loader->requests = requests_copy;
+  loader->request_count = request_count;
+  loader->options = *options;
+  loader->pool = pool;
+  loader->begin_counter = SDL_GetPerformanceCounter();
+  // no more workers than models
+  loader->worker_count = thread_count < 1 ? 1 : thread_count;
+  if (loader->worker_count > request_count) {
+    loader->worker_count = request_count;
+  }
+  loader->workers = calloc(loader->worker_count, sizeof(loader_worker_t));
+  // queues are created up front, a worker may finish before the next one
+  // starts
+  for (int w = 0; w < loader->worker_count; w++) {
+    loader->workers[w].loader = loader;
+    loader->workers[w].loaded_models = spsc_queue_create(request_count);
+  }
+  int started_count = 0;
+  for (int w = 0; w < loader->worker_count; w++) {
+    loader_worker_t* worker = &loader->workers[w];
+    worker->thread = SDL_CreateThread(worker_main, "asset-loader", worker);
+    if (worker->thread == NULL) {
+      printf("Failed to create loader thread: %s\n", SDL_GetError());
+      break;
+    }
+    started_count++;
+  }
+  if (started_count == 0 && loader->worker_count > 0) {
+    // fall back to loading everything up front
+    worker_main(&loader->workers[0]);
+  }
+  return loader;
+}
+
+void asset_loader_destroy(asset_loader_t* loader) {
+  if (loader == NULL) {
+    return;
+  }
+  SDL_AtomicSet(&loader->cancel, 1);
+  for (int w = 0; w < loader->worker_count; w++) {
+    loader_worker_t* worker = &loader->workers[w];
+    if (worker->thread != NULL) {
+      SDL_WaitThread(worker->thread, NULL);
+    }
+    void* item;
+    while (spsc_queue_pop(worker->loaded_models, &item)) {
+      loaded_model_t* loaded = item;
+      release_model(&loaded->model);
+      free(loaded);
+    }
+    spsc_queue_destroy(worker->loaded_models);
+  }
+  free(loader->workers);
+  free((void*)loader->requests);
+  free(loader);
+}
+
+bool asset_loader_poll(asset_loader_t* loader, loaded_model_t* loaded) {
+  // starts after the last worker polled so none is favored
+  for (int i = 0; i < loader->worker_count; i++) {
+    const int w = (loader->next_polled_worker + i) % loader->worker_count;
+    void* item;
+    if (!spsc_queue_pop(loader->workers[w].loaded_models, &item)) {
+      continue;
+    }
+    loader->next_polled_worker = (w + 1) % loader->worker_count;
+    *loaded = *(loaded_model_t*)item;
+    free(item);
+    loader->polled_count++;
+    if (loaded->load_ms > loader->slowest_load_ms) {
+      loader->slowest_load_ms = loaded->load_ms;
+    }
+    loader->total_load_ms += loaded->load_ms;
+    if (loader->polled_count == loader->request_count) {
+      printf(
+        "Loaded %d model(s) on %d thread(s) in %.2fms (slowest model "
+        "%.2fms, sum %.2fms)\n",
+        loader->request_count, loader->worker_count,
+        elapsed_ms(loader->begin_counter), loader->slowest_load_ms,
+        loader->total_load_ms);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool asset_loader_done(const asset_loader_t* loader) {
+  return loader->polled_count == loader->request_count;
+}
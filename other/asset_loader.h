@@ -0,0 +1,45 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "mesh.h"
+
+#include <stdbool.h>
+
+typedef struct job_pool_t job_pool_t;
+
+// loads models on background threads so the caller can keep rendering,
+// each worker hands its loaded models back through its own lock-free queue
+// (see spsc_queue.h) and they are picked up with asset_loader_poll
+typedef struct asset_loader_t asset_loader_t;
+
+// paths must outlive the loader
+typedef struct model_request_t {
+  const char* mesh_path;
+  const char* texture_path;
+  texture_import_options_t texture_options;
+} model_request_t;
+
+typedef struct loaded_model_t {
+  model_t model;
+  int request_index;
+  double load_ms; // time spent loading on the background thread
+} loaded_model_t;
+
+// up to thread_count workers take the requests in order and load them in
+// parallel, models arrive in the order they finish (see request_index),
+// requests should name distinct meshes (each writes its own mesh cache),
+// pool is optional (see load_obj_mesh_with_png_texture) and shared by the
+// workers
+asset_loader_t* asset_loader_create(
+  const model_request_t* requests, int request_count,
+  const mesh_import_options_t* options, job_pool_t* pool, int thread_count);
+// stops after the models being loaded (if any), models not yet polled are
+// released
+void asset_loader_destroy(asset_loader_t* loader);
+
+// returns false when no model has finished loading since the last call
+bool asset_loader_poll(asset_loader_t* loader, loaded_model_t* loaded);
+// true once every requested model was handed back
+bool asset_loader_done(const asset_loader_t* loader);
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,119 @@
+#include "block_cache.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// bump whenever the layout or contents of the cache change
+#define BlockCacheVersion 1
+#define BlockCacheAlignment 16
+
+static const char g_block_cache_magic[4] = {'S', 'B', 'C', 'T'};
+
+typedef struct block_cache_header_t {
+  char magic[4];
+  uint32_t version;
+  // revision of the source the cache was built from
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint32_t width;
+  uint32_t height;
+  uint32_t format; // block_format_e
+  uint32_t level_count;
+  double png_load_ms;
+  double encode_ms;
+  uint64_t data_size;
+  uint64_t data_offset;
+} block_cache_header_t;
+
+static uint64_t align_offset(const uint64_t offset) {
+  const uint64_t mask = BlockCacheAlignment - 1;
+  return (offset + mask) & ~mask;
+}
+
+void block_cache_path(
+  const char* source_path, char* cache_path, const int size) {
+  const char* extension = strrchr(source_path, '.');
+  const char* separator = strrchr(source_path, '/');
+  const int stem_length =
+    extension != NULL && (separator == NULL || extension > separator)
+      ? (int)(extension - source_path)
+      : (int)strlen(source_path);
+  snprintf(cache_path, size, "%.*s.sbc", stem_length, source_path);
+}
+
+bool block_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  compressed_texture_t* texture, double* png_load_ms, double* encode_ms) {
+  mapped_file_t file;
+  if (!mapped_file_open(&file, cache_path)) {
+    return false;
+  }
+
+  block_cache_header_t header;
+  if (file.size < sizeof header) {
+    mapped_file_close(&file);
+    return false;
+  }
+  memcpy(&header, file.data, sizeof header);
+
+  const bool valid_header =
+    memcmp(header.magic, g_block_cache_magic, sizeof header.magic) == 0
+    && header.version == BlockCacheVersion
+    && header.source_size == source_stamp->size
+    && header.source_mtime == source_stamp->mtime && header.width > 0
+    && header.height > 0 && header.format <= block_format_bc3
+    && header.level_count > 0 && header.level_count <= MaxMipLevelCount;
+  if (!valid_header) {
+    mapped_file_close(&file);
+    return false;
+  }
+  const compressed_texture_t layout = compressed_texture_layout(
+    (block_format_e)header.format, (int)header.width, (int)header.height,
+    (int)header.level_count);
+  if (
+    header.data_size != layout.size
+    || header.data_offset + header.data_size > file.size) {
+    mapped_file_close(&file);
+    return false;
+  }
+
+  *texture = layout;
+  texture->data = (const uint8_t*)(file.data + header.data_offset);
+  texture->cache_file = file;
+  *png_load_ms = header.png_load_ms;
+  *encode_ms = header.encode_ms;
+  return true;
+}
+
+bool block_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const compressed_texture_t* texture, const double png_load_ms,
+  const double encode_ms) {
+  block_cache_header_t header = {
+    .version = BlockCacheVersion,
+    .source_size = source_stamp->size,
+    .source_mtime = source_stamp->mtime,
+    .width = (uint32_t)texture->widths[0],
+    .height = (uint32_t)texture->heights[0],
+    .format = (uint32_t)texture->format,
+    .level_count = (uint32_t)texture->level_count,
+    .png_load_ms = png_load_ms,
+    .encode_ms = encode_ms,
+    .data_size = texture->size,
+    .data_offset = align_offset(sizeof header)};
+  memcpy(header.magic, g_block_cache_magic, sizeof header.magic);
+
+  char temporary_path[1024];
+  FILE* file =
+    cache_file_create(cache_path, temporary_path, sizeof temporary_path);
+  if (file == NULL) {
+    return false;
+  }
+  const bool written =
+    fwrite(&header, sizeof header, 1, file) == 1
+    && fseek(file, (long)header.data_offset, SEEK_SET) == 0
+    && (texture->size == 0
+        || fwrite(texture->data, texture->size, 1, file) == 1);
+  return cache_file_commit(file, temporary_path, cache_path, written);
+}
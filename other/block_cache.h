@@ -0,0 +1,27 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include "block_compress.h"
+
+#include <stdbool.h>
+
+// binary cache of the block compressed mip chain of a texture (.sbc) stored
+// next to it, blocks are accessed through a memory map and uploaded as is
+// (the png is not decoded when the cache is up to date)
+
+// replaces the extension of source_path with .sbc
+void block_cache_path(const char* source_path, char* cache_path, int size);
+
+// fails when the cache is missing, of a different version or was built for
+// a different revision (size or modification time) of the source than
+// source_stamp (taken before the source is read, and passed to save), the
+// time the png path took (decode and mip chain) and the encode time are
+// returned for comparison
+bool block_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  compressed_texture_t* texture, double* png_load_ms, double* encode_ms);
+bool block_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const compressed_texture_t* texture, double png_load_ms, double encode_ms);
+
+#endif // BLOCK_CACHE_H
@@ -0,0 +1,435 @@
+#include "block_compress.h"
+
+#include "job_pool.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 4x4 pixels, rgba8 row by row
+typedef struct pixel_block_t {
+  uint8_t rgba[16][4];
+} pixel_block_t;
+
+static int block_size(const block_format_e format) {
+  return format == block_format_bc1 ? 8 : 16;
+}
+
+block_format_e select_block_format(
+  const uint32_t* pixels, const size_t count) {
+  const uint8_t* bytes = (const uint8_t*)pixels;
+  for (size_t p = 0; p < count; p++) {
+    if (bytes[p * 4 + 3] != 255) {
+      return block_format_bc3;
+    }
+  }
+  return block_format_bc1;
+}
+
+compressed_texture_t compressed_texture_layout(
+  const block_format_e format, const int width, const int height,
+  const int level_count) {
+  compressed_texture_t texture = {
+    .format = format, .level_count = level_count};
+  const mip_chain_t mips = mip_chain_layout(width, height);
+  for (int l = 0; l < level_count; l++) {
+    texture.widths[l] = mips.widths[l];
+    texture.heights[l] = mips.heights[l];
+    texture.offsets[l] = texture.size;
+    texture.sizes[l] = (size_t)((mips.widths[l] + 3) / 4)
+                     * ((mips.heights[l] + 3) / 4) * block_size(format);
+    texture.size += texture.sizes[l];
+  }
+  return texture;
+}
+
+// edge blocks repeat the last row and column
+static void load_block(
+  const uint8_t* pixels, const int width, const int height, const int bx,
+  const int by, pixel_block_t* block) {
+  for (int y = 0; y < 4; y++) {
+    const int py = by * 4 + y < height ? by * 4 + y : height - 1;
+    for (int x = 0; x < 4; x++) {
+      const int px = bx * 4 + x < width ? bx * 4 + x : width - 1;
+      memcpy(block->rgba[y * 4 + x], pixels + ((size_t)py * width + px) * 4, 4);
+    }
+  }
+}
+
+static uint16_t pack_565(const float color[3]) {
+  const float scales[3] = {31.0f / 255.0f, 63.0f / 255.0f, 31.0f / 255.0f};
+  const int maxima[3] = {31, 63, 31};
+  int packed[3];
+  for (int c = 0; c < 3; c++) {
+    const int value = (int)lrintf(color[c] * scales[c]);
+    packed[c] = value < 0 ? 0 : value > maxima[c] ? maxima[c] : value;
+  }
+  return (uint16_t)((packed[0] << 11) | (packed[1] << 5) | packed[2]);
+}
+
+static void unpack_565(const uint16_t packed, int color[3]) {
+  const int r = (packed >> 11) & 31;
+  const int g = (packed >> 5) & 63;
+  const int b = packed & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+// four colors when c0 > c1, otherwise three and transparent black
+static void color_palette(
+  const uint16_t c0, const uint16_t c1, const bool four_colors,
+  int palette[4][3]) {
+  unpack_565(c0, palette[0]);
+  unpack_565(c1, palette[1]);
+  for (int c = 0; c < 3; c++) {
+    if (four_colors) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    } else {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+}
+
+// nearest of the four colors for each pixel (2 bits each, first pixel in
+// the lowest bits), returns the summed squared error
+static int match_colors(
+  const pixel_block_t* block, const int palette[4][3], uint32_t* indices) {
+  int error = 0;
+  *indices = 0;
+  for (int p = 0; p < 16; p++) {
+    int best_index = 0;
+    int best_distance = INT32_MAX;
+    for (int i = 0; i < 4; i++) {
+      int distance = 0;
+      for (int c = 0; c < 3; c++) {
+        const int delta = block->rgba[p][c] - palette[i][c];
+        distance += delta * delta;
+      }
+      if (distance < best_distance) {
+        best_distance = distance;
+        best_index = i;
+      }
+    }
+    *indices |= (uint32_t)best_index << (p * 2);
+    error += best_distance;
+  }
+  return error;
+}
+
+typedef struct color_fit_t {
+  uint16_t c0;
+  uint16_t c1;
+  uint32_t indices;
+  int error;
+} color_fit_t;
+
+// orders the endpoints for four color mode, equal endpoints select three
+// color mode where index 0 is still the endpoint
+static color_fit_t fit_endpoints(
+  const pixel_block_t* block, const float e0[3], const float e1[3]) {
+  color_fit_t fit = {.c0 = pack_565(e0), .c1 = pack_565(e1)};
+  if (fit.c0 < fit.c1) {
+    const uint16_t swap = fit.c0;
+    fit.c0 = fit.c1;
+    fit.c1 = swap;
+  }
+  if (fit.c0 == fit.c1) {
+    int palette[4][3];
+    color_palette(fit.c0, fit.c1, false, palette);
+    for (int p = 0; p < 16; p++) {
+      for (int c = 0; c < 3; c++) {
+        const int delta = block->rgba[p][c] - palette[0][c];
+        fit.error += delta * delta;
+      }
+    }
+    return fit;
+  }
+  int palette[4][3];
+  color_palette(fit.c0, fit.c1, true, palette);
+  fit.error = match_colors(block, palette, &fit.indices);
+  return fit;
+}
+
+static void principal_axis(
+  const pixel_block_t* block, const float mean[3], float axis[3]) {
+  float covariance[6] = {0}; // xx, xy, xz, yy, yz, zz
+  for (int p = 0; p < 16; p++) {
+    const float r = block->rgba[p][0] - mean[0];
+    const float g = block->rgba[p][1] - mean[1];
+    const float b = block->rgba[p][2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+  // power iteration converges on the axis of largest variance
+  float v[3] = {1.0f, 1.0f, 1.0f};
+  for (int iteration = 0; iteration < 8; iteration++) {
+    const float x =
+      covariance[0] * v[0] + covariance[1] * v[1] + covariance[2] * v[2];
+    const float y =
+      covariance[1] * v[0] + covariance[3] * v[1] + covariance[4] * v[2];
+    const float z =
+      covariance[2] * v[0] + covariance[4] * v[1] + covariance[5] * v[2];
+    const float length = sqrtf(x * x + y * y + z * z);
+    if (length < 1e-6f) {
+      break;
+    }
+    v[0] = x / length;
+    v[1] = y / length;
+    v[2] = z / length;
+  }
+  memcpy(axis, v, sizeof v);
+}
+
+static void encode_color_block(const pixel_block_t* block, uint8_t* out) {
+  float mean[3] = {0};
+  for (int p = 0; p < 16; p++) {
+    for (int c = 0; c < 3; c++) {
+      mean[c] += block->rgba[p][c] / 16.0f;
+    }
+  }
+  float axis[3];
+  principal_axis(block, mean, axis);
+  float min_t = 0.0f;
+  float max_t = 0.0f;
+  for (int p = 0; p < 16; p++) {
+    const float t = (block->rgba[p][0] - mean[0]) * axis[0]
+                  + (block->rgba[p][1] - mean[1]) * axis[1]
+                  + (block->rgba[p][2] - mean[2]) * axis[2];
+    min_t = t < min_t ? t : min_t;
+    max_t = t > max_t ? t : max_t;
+  }
+  float e0[3];
+  float e1[3];
+  for (int c = 0; c < 3; c++) {
+    e0[c] = mean[c] + axis[c] * max_t;
+    e1[c] = mean[c] + axis[c] * min_t;
+  }
+  color_fit_t fit = fit_endpoints(block, e0, e1);
+
+  // least squares endpoints for the chosen indices, each pixel is
+  // weight * c0 + (1 - weight) * c1
+  if (fit.c0 != fit.c1) {
+    const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ap[3] = {0};
+    float bp[3] = {0};
+    for (int p = 0; p < 16; p++) {
+      const float a = weights[(fit.indices >> (p * 2)) & 3];
+      const float b = 1.0f - a;
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+      for (int c = 0; c < 3; c++) {
+        ap[c] += a * block->rgba[p][c];
+        bp[c] += b * block->rgba[p][c];
+      }
+    }
+    const float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) > 1e-6f) {
+      float r0[3];
+      float r1[3];
+      for (int c = 0; c < 3; c++) {
+        r0[c] = (ap[c] * bb - bp[c] * ab) / determinant;
+        r1[c] = (bp[c] * aa - ap[c] * ab) / determinant;
+      }
+      const color_fit_t refined = fit_endpoints(block, r0, r1);
+      if (refined.error < fit.error) {
+        fit = refined;
+      }
+    }
+  }
+
+  out[0] = (uint8_t)(fit.c0 & 0xff);
+  out[1] = (uint8_t)(fit.c0 >> 8);
+  out[2] = (uint8_t)(fit.c1 & 0xff);
+  out[3] = (uint8_t)(fit.c1 >> 8);
+  for (int b = 0; b < 4; b++) {
+    out[4 + b] = (uint8_t)(fit.indices >> (b * 8));
+  }
+}
+
+// eight interpolated values between the largest (a0) and smallest alpha
+static void alpha_palette(const int a0, const int a1, int palette[8]) {
+  palette[0] = a0;
+  palette[1] = a1;
+  if (a0 > a1) {
+    for (int i = 2; i < 8; i++) {
+      palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    }
+  } else {
+    // six values, then fully transparent and opaque
+    for (int i = 2; i < 6; i++) {
+      palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+static void encode_alpha_block(const pixel_block_t* block, uint8_t* out) {
+  int a0 = 0;
+  int a1 = 255;
+  for (int p = 0; p < 16; p++) {
+    const int alpha = block->rgba[p][3];
+    a0 = alpha > a0 ? alpha : a0;
+    a1 = alpha < a1 ? alpha : a1;
+  }
+  out[0] = (uint8_t)a0;
+  out[1] = (uint8_t)a1;
+  uint64_t indices = 0;
+  if (a0 != a1) {
+    int palette[8];
+    alpha_palette(a0, a1, palette);
+    for (int p = 0; p < 16; p++) {
+      int best_index = 0;
+      int best_distance = INT32_MAX;
+      for (int i = 0; i < 8; i++) {
+        const int distance = abs(block->rgba[p][3] - palette[i]);
+        if (distance < best_distance) {
+          best_distance = distance;
+          best_index = i;
+        }
+      }
+      indices |= (uint64_t)best_index << (p * 3);
+    }
+  }
+  for (int b = 0; b < 6; b++) {
+    out[2 + b] = (uint8_t)(indices >> (b * 8));
+  }
+}
+
+typedef struct compress_job_t {
+  compressed_texture_t* texture;
+  const uint8_t* levels[MaxMipLevelCount];
+  // first row of blocks of each level (a job compresses one row)
+  int first_rows[MaxMipLevelCount + 1];
+} compress_job_t;
+
+static void compress_row_job(void* user_data, const int job_index) {
+  compress_job_t* job = user_data;
+  compressed_texture_t* texture = job->texture;
+  int level = 0;
+  while (job_index >= job->first_rows[level + 1]) {
+    level++;
+  }
+  const int width = texture->widths[level];
+  const int height = texture->heights[level];
+  const int block_width = (width + 3) / 4;
+  const int by = job_index - job->first_rows[level];
+  const int size = block_size(texture->format);
+  uint8_t* out = (uint8_t*)texture->data + texture->offsets[level]
+               + (size_t)by * block_width * size;
+  for (int bx = 0; bx < block_width; bx++, out += size) {
+    pixel_block_t block;
+    load_block(job->levels[level], width, height, bx, by, &block);
+    if (texture->format == block_format_bc3) {
+      encode_alpha_block(&block, out);
+      encode_color_block(&block, out + 8);
+    } else {
+      encode_color_block(&block, out);
+    }
+  }
+}
+
+compressed_texture_t compress_texture(
+  const block_format_e format, const uint32_t* pixels, const int width,
+  const int height, const mip_chain_t* mips, job_pool_t* pool) {
+  const int level_count =
+    mips != NULL && mips->level_count > 1 ? mips->level_count : 1;
+  compressed_texture_t texture =
+    compressed_texture_layout(format, width, height, level_count);
+  texture.data = malloc(texture.size);
+  compress_job_t job = {.texture = &texture};
+  for (int l = 0; l < level_count; l++) {
+    job.levels[l] = l == 0 ? (const uint8_t*)pixels
+                           : (const uint8_t*)(mips->pixels + mips->offsets[l]);
+    job.first_rows[l + 1] = job.first_rows[l] + (texture.heights[l] + 3) / 4;
+  }
+  const int row_count = job.first_rows[level_count];
+  if (pool != NULL) {
+    job_pool_run(pool, row_count, compress_row_job, &job);
+  } else {
+    for (int r = 0; r < row_count; r++) {
+      compress_row_job(&job, r);
+    }
+  }
+  return texture;
+}
+
+static void decode_color_block(
+  const uint8_t* in, const bool always_four_colors, pixel_block_t* block) {
+  const uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+  const uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+  const uint32_t indices =
+    (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16)
+    | ((uint32_t)in[7] << 24);
+  const bool four_colors = always_four_colors || c0 > c1;
+  int palette[4][3];
+  color_palette(c0, c1, four_colors, palette);
+  for (int p = 0; p < 16; p++) {
+    const int index = (indices >> (p * 2)) & 3;
+    for (int c = 0; c < 3; c++) {
+      block->rgba[p][c] = (uint8_t)palette[index][c];
+    }
+    block->rgba[p][3] = !four_colors && index == 3 ? 0 : 255;
+  }
+}
+
+static void decode_alpha_block(const uint8_t* in, pixel_block_t* block) {
+  int palette[8];
+  alpha_palette(in[0], in[1], palette);
+  uint64_t indices = 0;
+  for (int b = 0; b < 6; b++) {
+    indices |= (uint64_t)in[2 + b] << (b * 8);
+  }
+  for (int p = 0; p < 16; p++) {
+    block->rgba[p][3] = (uint8_t)palette[(indices >> (p * 3)) & 7];
+  }
+}
+
+void decompress_texture_level(
+  const compressed_texture_t* texture, const int level, uint32_t* pixels) {
+  const int width = texture->widths[level];
+  const int height = texture->heights[level];
+  const int block_width = (width + 3) / 4;
+  const int block_height = (height + 3) / 4;
+  const int size = block_size(texture->format);
+  const uint8_t* in = texture->data + texture->offsets[level];
+  uint8_t* bytes = (uint8_t*)pixels;
+  for (int by = 0; by < block_height; by++) {
+    for (int bx = 0; bx < block_width; bx++, in += size) {
+      pixel_block_t block;
+      if (texture->format == block_format_bc3) {
+        decode_color_block(in + 8, true, &block);
+        decode_alpha_block(in, &block);
+      } else {
+        decode_color_block(in, false, &block);
+      }
+      for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+        for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+          memcpy(
+            bytes + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4,
+            block.rgba[y * 4 + x], 4);
+        }
+      }
+    }
+  }
+}
+
+void free_compressed_texture(compressed_texture_t* texture) {
+  if (texture->cache_file.data != NULL) {
+    mapped_file_close(&texture->cache_file);
+  } else {
+    free((void*)texture->data);
+  }
+  *texture = (compressed_texture_t){0};
+}
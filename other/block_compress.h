@@ -0,0 +1,49 @@
+#ifndef BLOCK_COMPRESS_H
+#define BLOCK_COMPRESS_H
+
+#include "mapped_file.h"
+#include "mipmap.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct job_pool_t job_pool_t;
+
+typedef enum block_format_e {
+  block_format_bc1, // rgb, 8 bytes per 4x4 block
+  block_format_bc3 // rgba (bc1 color and interpolated alpha), 16 bytes
+} block_format_e;
+
+// every mip level of a texture (level 0 included) as 4x4 blocks
+typedef struct compressed_texture_t {
+  block_format_e format;
+  int level_count; // 0 when the texture is not compressed
+  int widths[MaxMipLevelCount];
+  int heights[MaxMipLevelCount];
+  // levels packed one after another, in bytes
+  size_t offsets[MaxMipLevelCount];
+  size_t sizes[MaxMipLevelCount];
+  const uint8_t* data;
+  size_t size;
+  // set when data points into a cache file (see block_cache.h)
+  mapped_file_t cache_file;
+} compressed_texture_t;
+
+// bc3 when any pixel is not opaque, bc1 otherwise
+block_format_e select_block_format(const uint32_t* pixels, size_t count);
+// sizes and offsets of the levels, without data
+compressed_texture_t compressed_texture_layout(
+  block_format_e format, int width, int height, int level_count);
+// compresses level 0 (pixels) and the levels of mips (optional), rows of
+// blocks are spread across the pool (optional), each block is fit along the
+// principal axis of its colors and refined once by least squares
+compressed_texture_t compress_texture(
+  block_format_e format, const uint32_t* pixels, int width, int height,
+  const mip_chain_t* mips, job_pool_t* pool);
+// writes the widths[level] x heights[level] pixels of a level as rgba8
+void decompress_texture_level(
+  const compressed_texture_t* texture, int level, uint32_t* pixels);
+void free_compressed_texture(compressed_texture_t* texture);
+
+#endif // BLOCK_COMPRESS_H
@@ -0,0 +1,172 @@
+#include "file_watcher.h"
+
+#include <SDL.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// files without an inotify watch are checked at most this often
+#define FileWatcherPollIntervalMs 250
+
+typedef struct watched_file_t {
+  const char* path;
+  const char* name; // within its directory
+  int watch; // inotify watch of the directory, -1 when polled
+  // last seen revision (when polled)
+  int64_t mtime;
+  int64_t size;
+} watched_file_t;
+
+struct file_watcher_t {
+  watched_file_t* files;
+  int file_count;
+  int inotify_fd; // -1 without inotify
+  uint32_t last_poll_ticks;
+};
+
+static void file_revision(const char* path, int64_t* mtime, int64_t* size) {
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    *mtime = 0;
+    *size = -1;
+    return;
+  }
+  *mtime = (int64_t)st.st_mtime;
+  *size = (int64_t)st.st_size;
+}
+
+#ifdef __linux__
+static int watch_directory(const int inotify_fd, watched_file_t* file) {
+  const char* separator = strrchr(file->path, '/');
+  char directory[1024];
+  if (separator == NULL) {
+    snprintf(directory, sizeof directory, ".");
+  } else if (separator == file->path) {
+    snprintf(directory, sizeof directory, "/");
+  } else {
+    snprintf(
+      directory, sizeof directory, "%.*s", (int)(separator - file->path),
+      file->path);
+  }
+  // editors and exporters often write a temporary file and rename it over
+  // the original, so renames into the directory count as writes
+  return inotify_add_watch(inotify_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+}
+#endif
+
+file_watcher_t* file_watcher_create(
+  const char* const* paths, const int path_count) {
+  file_watcher_t* watcher = calloc(1, sizeof(file_watcher_t));
+  watcher->files = calloc(path_count, sizeof(watched_file_t));
+  watcher->file_count = path_count;
+  watcher->inotify_fd = -1;
+#ifdef __linux__
+  watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watcher->inotify_fd < 0) {
+    printf("Failed to initialize inotify, polling for file changes\n");
+  }
+#endif
+  for (int p = 0; p < path_count; p++) {
+    watched_file_t* file = &watcher->files[p];
+    file->path = paths[p];
+    const char* separator = strrchr(paths[p], '/');
+    file->name = separator != NULL ? separator + 1 : paths[p];
+    file->watch = -1;
+#ifdef __linux__
+    if (watcher->inotify_fd >= 0) {
+      // watching the same directory twice returns the same watch
+      file->watch = watch_directory(watcher->inotify_fd, file);
+      if (file->watch < 0) {
+        printf("Failed to watch %s, polling it instead\n", file->path);
+      }
+    }
+#endif
+    file_revision(file->path, &file->mtime, &file->size);
+  }
+  watcher->last_poll_ticks = SDL_GetTicks();
+  return watcher;
+}
+
+void file_watcher_destroy(file_watcher_t* watcher) {
+  if (watcher == NULL) {
+    return;
+  }
+#ifdef __linux__
+  if (watcher->inotify_fd >= 0) {
+    close(watcher->inotify_fd); // removes the watches
+  }
+#endif
+  free(watcher->files);
+  free(watcher);
+}
+
+int file_watcher_poll(file_watcher_t* watcher, bool* changed) {
+  for (int p = 0; p < watcher->file_count; p++) {
+    changed[p] = false;
+  }
+#ifdef __linux__
+  if (watcher->inotify_fd >= 0) {
+    // events have a variable length name, the buffer is aligned for the
+    // fixed part
+    char buffer[4096]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+      // fails with EAGAIN once every pending event was read
+      const ssize_t length = read(watcher->inotify_fd, buffer, sizeof buffer);
+      if (length <= 0) {
+        break;
+      }
+      for (ssize_t offset = 0; offset < length;) {
+        const struct inotify_event* event =
+          (const struct inotify_event*)(buffer + offset);
+        offset += (ssize_t)sizeof(struct inotify_event) + event->len;
+        for (int p = 0; p < watcher->file_count; p++) {
+          const watched_file_t* file = &watcher->files[p];
+          if (file->watch < 0) {
+            continue;
+          }
+          // events were dropped, assume everything changed
+          if ((event->mask & IN_Q_OVERFLOW) != 0) {
+            changed[p] = true;
+          } else if (
+            event->wd == file->watch && event->len > 0
+            && strcmp(event->name, file->name) == 0) {
+            changed[p] = true;
+          }
+        }
+      }
+    }
+  }
+#endif
+  const uint32_t ticks = SDL_GetTicks();
+  if (ticks - watcher->last_poll_ticks >= FileWatcherPollIntervalMs) {
+    watcher->last_poll_ticks = ticks;
+    for (int p = 0; p < watcher->file_count; p++) {
+      watched_file_t* file = &watcher->files[p];
+      if (file->watch >= 0) {
+        continue;
+      }
+      int64_t mtime;
+      int64_t size;
+      file_revision(file->path, &mtime, &size);
+      if (mtime != file->mtime || size != file->size) {
+        file->mtime = mtime;
+        file->size = size;
+        changed[p] = true;
+      }
+    }
+  }
+  int changed_count = 0;
+  for (int p = 0; p < watcher->file_count; p++) {
+    changed_count += changed[p] ? 1 : 0;
+  }
+  return changed_count;
+}
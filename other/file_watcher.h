@@ -0,0 +1,19 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <stdbool.h>
+
+// reports writes to a set of files without blocking, with inotify on linux
+// (watching the parent directories, so files replaced by a rename are seen
+// too) and by polling modification times elsewhere
+typedef struct file_watcher_t file_watcher_t;
+
+// paths must outlive the watcher
+file_watcher_t* file_watcher_create(const char* const* paths, int path_count);
+void file_watcher_destroy(file_watcher_t* watcher);
+
+// sets changed[p] to whether the path was written since the last call and
+// returns how many of them changed
+int file_watcher_poll(file_watcher_t* watcher, bool* changed);
+
+#endif // FILE_WATCHER_H
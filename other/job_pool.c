@@ -0,0 +1,123 @@
+#include "job_pool.h"
+
+#include <SDL.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct job_pool_t {
+  SDL_Thread** workers;
+  int worker_count;
+  // held for a whole batch, so batches from several threads queue up
+  SDL_mutex* batch_mutex;
+  SDL_mutex* mutex;
+  SDL_cond* work_available;
+  SDL_cond* work_complete;
+  // current batch (guarded by mutex)
+  job_fn job;
+  void* user_data;
+  int job_count;
+  int next_job;
+  int completed_jobs;
+  int generation;
+  bool quit;
+};
+
+// called with the mutex held, returns with the mutex held
+static void run_available_jobs(job_pool_t* pool) {
+  while (pool->next_job < pool->job_count) {
+    const int job_index = pool->next_job++;
+    SDL_UnlockMutex(pool->mutex);
+    pool->job(pool->user_data, job_index);
+    SDL_LockMutex(pool->mutex);
+    if (++pool->completed_jobs == pool->job_count) {
+      SDL_CondSignal(pool->work_complete);
+    }
+  }
+}
+
+static int worker_main(void* data) {
+  job_pool_t* pool = data;
+  int seen_generation = 0;
+  SDL_LockMutex(pool->mutex);
+  for (;;) {
+    while (!pool->quit && pool->generation == seen_generation) {
+      SDL_CondWait(pool->work_available, pool->mutex);
+    }
+    if (pool->quit) {
+      break;
+    }
+    seen_generation = pool->generation;
+    run_available_jobs(pool);
+  }
+  SDL_UnlockMutex(pool->mutex);
+  return 0;
+}
+
+job_pool_t* job_pool_create(const int thread_count) {
+  job_pool_t* pool = calloc(1, sizeof(job_pool_t));
+  pool->batch_mutex = SDL_CreateMutex();
+  pool->mutex = SDL_CreateMutex();
+  pool->work_available = SDL_CreateCond();
+  pool->work_complete = SDL_CreateCond();
+  const int worker_count = thread_count > 1 ? thread_count - 1 : 0;
+  if (worker_count > 0) {
+    pool->workers = calloc(worker_count, sizeof(SDL_Thread*));
+    for (int w = 0; w < worker_count; w++) {
+      SDL_Thread* worker = SDL_CreateThread(worker_main, "job-pool", pool);
+      if (worker == NULL) {
+        printf("Failed to create worker thread: %s\n", SDL_GetError());
+        break;
+      }
+      pool->workers[pool->worker_count++] = worker;
+    }
+  }
+  return pool;
+}
+
+void job_pool_destroy(job_pool_t* pool) {
+  if (pool == NULL) {
+    return;
+  }
+  SDL_LockMutex(pool->mutex);
+  pool->quit = true;
+  SDL_CondBroadcast(pool->work_available);
+  SDL_UnlockMutex(pool->mutex);
+  for (int w = 0; w < pool->worker_count; w++) {
+    SDL_WaitThread(pool->workers[w], NULL);
+  }
+  SDL_DestroyCond(pool->work_complete);
+  SDL_DestroyCond(pool->work_available);
+  SDL_DestroyMutex(pool->mutex);
+  SDL_DestroyMutex(pool->batch_mutex);
+  free(pool->workers);
+  free(pool);
+}
+
+int job_pool_thread_count(const job_pool_t* pool) {
+  return pool->worker_count + 1;
+}
+
+void job_pool_run(
+  job_pool_t* pool, const int job_count, const job_fn job, void* user_data) {
+  if (job_count <= 0) {
+    return;
+  }
+  SDL_LockMutex(pool->batch_mutex);
+  SDL_LockMutex(pool->mutex);
+  pool->job = job;
+  pool->user_data = user_data;
+  pool->job_count = job_count;
+  pool->next_job = 0;
+  pool->completed_jobs = 0;
+  pool->generation++;
+  SDL_CondBroadcast(pool->work_available);
+  // the calling thread takes part in the batch too
+  run_available_jobs(pool);
+  while (pool->completed_jobs < pool->job_count) {
+    SDL_CondWait(pool->work_complete, pool->mutex);
+  }
+  SDL_UnlockMutex(pool->mutex);
+  SDL_UnlockMutex(pool->batch_mutex);
+}
@@ -0,0 +1,21 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+// fixed size pool of worker threads for data parallel work
+// (a batch of jobs is split across the workers and the calling thread)
+
+typedef struct job_pool_t job_pool_t;
+
+typedef void (*job_fn)(void* user_data, int job_index);
+
+// thread_count includes the calling thread (thread_count - 1 workers)
+job_pool_t* job_pool_create(int thread_count);
+void job_pool_destroy(job_pool_t* pool);
+int job_pool_thread_count(const job_pool_t* pool);
+
+// invoke job(user_data, i) for i in [0, job_count) and wait for completion
+// can be called from several threads, their batches run one after another
+// (a job must not call it on the same pool)
+void job_pool_run(job_pool_t* pool, int job_count, job_fn job, void* user_data);
+
+#endif // JOB_POOL_H
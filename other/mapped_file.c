@@ -0,0 +1,138 @@
+#include "mapped_file.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+bool mapped_file_open(mapped_file_t* mapped_file, const char* path) {
+  *mapped_file = (mapped_file_t){0};
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+    path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  mapped_file->file_handle = file;
+  mapped_file->size = (size_t)size.QuadPart;
+  if (mapped_file->size == 0) {
+    // zero length files cannot be mapped, treat as empty
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    CloseHandle(file);
+    *mapped_file = (mapped_file_t){0};
+    return false;
+  }
+  mapped_file->mapping_handle = mapping;
+  mapped_file->data =
+    (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (mapped_file->data == NULL) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    *mapped_file = (mapped_file_t){0};
+    return false;
+  }
+  return true;
+#else
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  mapped_file->size = (size_t)st.st_size;
+  if (mapped_file->size == 0) {
+    // zero length files cannot be mapped, treat as empty
+    close(fd);
+    return true;
+  }
+  void* data = mmap(NULL, mapped_file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference to the file
+  close(fd);
+  if (data == MAP_FAILED) {
+    *mapped_file = (mapped_file_t){0};
+    return false;
+  }
+  madvise(data, mapped_file->size, MADV_SEQUENTIAL);
+  mapped_file->data = (const char*)data;
+  return true;
+#endif
+}
+
+void mapped_file_close(mapped_file_t* mapped_file) {
+#ifdef _WIN32
+  if (mapped_file->data != NULL) {
+    UnmapViewOfFile(mapped_file->data);
+  }
+  if (mapped_file->mapping_handle != NULL) {
+    CloseHandle(mapped_file->mapping_handle);
+  }
+  if (mapped_file->file_handle != NULL) {
+    CloseHandle(mapped_file->file_handle);
+  }
+#else
+  if (mapped_file->data != NULL) {
+    munmap((void*)mapped_file->data, mapped_file->size);
+  }
+#endif
+  *mapped_file = (mapped_file_t){0};
+}
+
+bool file_stamp(const char* path, file_stamp_t* stamp) {
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    return false;
+  }
+  stamp->size = (uint64_t)st.st_size;
+#ifdef __linux__
+  // a re-export within the same second is still noticed
+  stamp->mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+  stamp->mtime = (int64_t)st.st_mtime;
+#endif
+  return true;
+}
+
+FILE* cache_file_create(
+  const char* path, char* temporary_path, const int size) {
+  if (snprintf(temporary_path, size, "%s.tmp", path) >= size) {
+    return NULL;
+  }
+  return fopen(temporary_path, "wb");
+}
+
+bool cache_file_commit(
+  FILE* file, const char* temporary_path, const char* path,
+  const bool written) {
+  const bool closed = fclose(file) == 0;
+#ifdef _WIN32
+  const bool replaced =
+    written && closed
+    && MoveFileExA(temporary_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+  const bool replaced =
+    written && closed && rename(temporary_path, path) == 0;
+#endif
+  if (!replaced) {
+    remove(temporary_path);
+  }
+  return replaced;
+}
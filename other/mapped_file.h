@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// read-only view of an entire file mapped into the address space
+typedef struct mapped_file_t {
+  const char* data;
+  size_t size;
+#ifdef _WIN32
+  void* file_handle;
+  void* mapping_handle;
+#endif
+} mapped_file_t;
+
+bool mapped_file_open(mapped_file_t* mapped_file, const char* path);
+void mapped_file_close(mapped_file_t* mapped_file);
+
+// size and modification time of a file (nanoseconds on linux, seconds
+// elsewhere), used to tell whether a cache built from it is up to date
+typedef struct file_stamp_t {
+  uint64_t size;
+  int64_t mtime;
+} file_stamp_t;
+
+// take the stamp before reading the source, a source saved while it is
+// imported then leaves a cache that is stale instead of one that is trusted
+bool file_stamp(const char* path, file_stamp_t* stamp);
+
+// caches are written to path.tmp (see temporary_path) and moved over path
+// once complete, a cache that is still mapped (by a model or texture in
+// use) keeps its contents instead of being truncated under the mapping
+FILE* cache_file_create(const char* path, char* temporary_path, int size);
+// closes file and replaces path with it when written, removes it otherwise
+// (or when path can't be replaced, a mapped file on windows)
+bool cache_file_commit(
+  FILE* file, const char* temporary_path, const char* path, bool written);
+
+#endif // MAPPED_FILE_H
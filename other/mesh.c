@@ -1,81 +1,1020 @@
 #include "mesh.h"
 
 #include "array.h"
+#include "job_pool.h"
+#include "mapped_file.h"
+#include "mesh_cache.h"
+#include "mesh_optimize.h"
+#include "mesh_simplify.h"
+#include "meshlet.h"
+#include "quantize.h"
 #include "texture.h"
 
+#include <SDL.h>
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-model_t load_obj_mesh(const char* mesh_path) {
+typedef struct obj_counts_t {
+  int vertex_count;
+  int uv_count;
+  int face_count;
+} obj_counts_t;
+
+// largest vertex count addressable with 16-bit indices
+#define Max16BitVertexCount 65536
+
+typedef enum obj_record_e {
+  obj_record_other,
+  obj_record_vertex,
+  obj_record_uv,
+  obj_record_face
+} obj_record_e;
+
+static const double g_powers_of_ten[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static bool is_blank(const char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+static const char* skip_blanks(const char* cursor, const char* end) {
+  while (cursor < end && is_blank(*cursor)) {
+    cursor++;
+  }
+  return cursor;
+}
+
+static const char* skip_token(const char* cursor, const char* end) {
+  while (cursor < end && !is_blank(*cursor) && *cursor != '\n') {
+    cursor++;
+  }
+  return cursor;
+}
+
+static const char* end_of_line(const char* cursor, const char* end) {
+  const char* newline = memchr(cursor, '\n', end - cursor);
+  return newline != NULL ? newline : end;
+}
+
+// locale independent replacement for atof (no copies, no allocations)
+static const char* parse_float(
+  const char* cursor, const char* end, float* value) {
+  bool negative = false;
+  if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+    negative = *cursor == '-';
+    cursor++;
+  }
+  // accumulate up to 19 significant digits, the rest only shift the exponent
+  uint64_t mantissa = 0;
+  int significant_digits = 0;
+  int exponent = 0;
+  for (; cursor < end && is_digit(*cursor); cursor++) {
+    if (significant_digits < 19) {
+      mantissa = mantissa * 10 + (uint64_t)(*cursor - '0');
+      significant_digits += mantissa != 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (cursor < end && *cursor == '.') {
+    cursor++;
+    for (; cursor < end && is_digit(*cursor); cursor++) {
+      if (significant_digits < 19) {
+        mantissa = mantissa * 10 + (uint64_t)(*cursor - '0');
+        significant_digits += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+  if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+    cursor++;
+    bool negative_exponent = false;
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+      negative_exponent = *cursor == '-';
+      cursor++;
+    }
+    int explicit_exponent = 0;
+    for (; cursor < end && is_digit(*cursor); cursor++) {
+      if (explicit_exponent < 10000) {
+        explicit_exponent = explicit_exponent * 10 + (*cursor - '0');
+      }
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  double result = (double)mantissa;
+  if (exponent < 0) {
+    for (; exponent < -22 && result != 0.0; exponent += 22) {
+      result /= g_powers_of_ten[22];
+    }
+    result /= g_powers_of_ten[exponent < -22 ? 22 : -exponent];
+  } else {
+    for (; exponent > 22; exponent -= 22) {
+      result *= g_powers_of_ten[22];
+    }
+    result *= g_powers_of_ten[exponent];
+  }
+  *value = (float)(negative ? -result : result);
+  return cursor;
+}
+
+static const char* parse_int(const char* cursor, const char* end, int* value) {
+  bool negative = false;
+  if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+    negative = *cursor == '-';
+    cursor++;
+  }
+  // saturates (the index is then out of range and the face skipped)
+  int result = 0;
+  for (; cursor < end && is_digit(*cursor); cursor++) {
+    result = result > (INT_MAX - 9) / 10 ? INT_MAX
+                                          : result * 10 + (*cursor - '0');
+  }
+  *value = negative ? -result : result;
+  return cursor;
+}
+
+// obj indices are 1-based, negative indices are relative to the end of the
+// elements read so far (-1 is the most recent)
+static int resolve_obj_index(const int index, const int count) {
+  return index < 0 ? count + index + 1 : index;
+}
+
+static obj_record_e classify_obj_line(const char** cursor, const char* end) {
+  const char* line = *cursor;
+  if (end - line >= 2 && line[0] == 'v' && is_blank(line[1])) {
+    *cursor = line + 2;
+    return obj_record_vertex;
+  }
+  if (
+    end - line >= 3 && line[0] == 'v' && line[1] == 't'
+    && is_blank(line[2])) {
+    *cursor = line + 3;
+    return obj_record_uv;
+  }
+  if (end - line >= 2 && line[0] == 'f' && is_blank(line[1])) {
+    *cursor = line + 2;
+    return obj_record_face;
+  }
+  return obj_record_other;
+}
+
+// first pass, count records so every array can be allocated exactly once
+static obj_counts_t count_obj_records(const char* begin, const char* end) {
+  obj_counts_t counts = {0};
+  for (const char* cursor = begin; cursor < end;) {
+    const char* line_end = end_of_line(cursor, end);
+    const char* line = skip_blanks(cursor, line_end);
+    switch (classify_obj_line(&line, line_end)) {
+      case obj_record_vertex:
+        counts.vertex_count++;
+        break;
+      case obj_record_uv:
+        counts.uv_count++;
+        break;
+      case obj_record_face: {
+        // polygons are triangulated as a fan
+        int corner_count = 0;
+        for (line = skip_blanks(line, line_end); line < line_end;
+             line = skip_blanks(skip_token(line, line_end), line_end)) {
+          corner_count++;
+        }
+        if (corner_count >= 3) {
+          counts.face_count += corner_count - 2;
+        }
+      } break;
+      default:
+        break;
+    }
+    cursor = line_end + 1;
+  }
+  return counts;
+}
+
+// second pass, parse records into the preallocated arrays starting at offset
+static void parse_obj_records(
+  const char* begin, const char* end, mesh_t* mesh, obj_counts_t offset) {
+  obj_counts_t counts = offset;
+  for (const char* cursor = begin; cursor < end;) {
+    const char* line_end = end_of_line(cursor, end);
+    const char* line = skip_blanks(cursor, line_end);
+    switch (classify_obj_line(&line, line_end)) {
+      case obj_record_vertex: {
+        as_point3f vertex = {0};
+        float* elements[] = {&vertex.x, &vertex.y, &vertex.z};
+        for (int i = 0; i < 3; i++) {
+          line =
+            parse_float(skip_blanks(line, line_end), line_end, elements[i]);
+        }
+        mesh->vertices[counts.vertex_count++] = vertex;
+      } break;
+      case obj_record_uv: {
+        tex2f_t uv = {0};
+        line = parse_float(skip_blanks(line, line_end), line_end, &uv.u);
+        line = parse_float(skip_blanks(line, line_end), line_end, &uv.v);
+        mesh->uvs[counts.uv_count++] = uv;
+      } break;
+      case obj_record_face: {
+        int vert_indices[3] = {0};
+        int uv_indices[3] = {0};
+        int corner = 0;
+        for (line = skip_blanks(line, line_end); line < line_end;
+             line = skip_blanks(skip_token(line, line_end), line_end)) {
+          // corner is v, v/vt, v/vt/vn or v//vn
+          int vert_index = 0;
+          int uv_index = 0;
+          const char* element = parse_int(line, line_end, &vert_index);
+          if (element < line_end && *element == '/') {
+            parse_int(element + 1, line_end, &uv_index);
+          }
+          vert_index = resolve_obj_index(vert_index, counts.vertex_count);
+          uv_index = uv_index == 0
+                     ? 0
+                     : resolve_obj_index(uv_index, counts.uv_count);
+          if (corner < 3) {
+            vert_indices[corner] = vert_index;
+            uv_indices[corner] = uv_index;
+          } else {
+            vert_indices[1] = vert_indices[2];
+            uv_indices[1] = uv_indices[2];
+            vert_indices[2] = vert_index;
+            uv_indices[2] = uv_index;
+          }
+          if (++corner >= 3) {
+            face_t* face = &mesh->faces[counts.face_count++];
+            memcpy(face->vert_indices, vert_indices, sizeof vert_indices);
+            memcpy(face->uv_indices, uv_indices, sizeof uv_indices);
+          }
+        }
+      } break;
+      default:
+        break;
+    }
+    cursor = line_end + 1;
+  }
+}
+
+static void allocate_mesh_arrays(
+  mesh_t* mesh, const obj_counts_t counts, arena_t* arena) {
+  mesh->vertices =
+    arena_alloc_array(arena, counts.vertex_count, sizeof(as_point3f));
+  mesh->uvs = arena_alloc_array(arena, counts.uv_count, sizeof(tex2f_t));
+  mesh->faces = arena_alloc_array(arena, counts.face_count, sizeof(face_t));
+  mesh->vertex_count = counts.vertex_count;
+  mesh->uv_count = counts.uv_count;
+  mesh->face_count = counts.face_count;
+}
+
+model_t load_obj_mesh(const char* mesh_path, arena_t* arena) {
+  model_t model = (model_t){.scale = (as_vec3f){1.0f, 1.0f, 1.0f}};
+
+  mapped_file_t file;
+  if (!mapped_file_open(&file, mesh_path)) {
+    printf("Failed to open mesh: %s\n", mesh_path);
+    return model;
+  }
+
+  const char* begin = file.data;
+  const char* end = file.data + file.size;
+
+  allocate_mesh_arrays(&model.mesh, count_obj_records(begin, end), arena);
+  parse_obj_records(begin, end, &model.mesh, (obj_counts_t){0});
+
+  mapped_file_close(&file);
+  return model;
+}
+
+// newline aligned range of the file handled by one job
+typedef struct obj_chunk_t {
+  const char* begin;
+  const char* end;
+  obj_counts_t counts;
+  obj_counts_t offset;
+} obj_chunk_t;
+
+typedef struct obj_chunk_jobs_t {
+  obj_chunk_t* chunks;
+  mesh_t* mesh;
+} obj_chunk_jobs_t;
+
+static void count_obj_chunk_job(void* user_data, const int chunk_index) {
+  obj_chunk_t* chunk = &((obj_chunk_jobs_t*)user_data)->chunks[chunk_index];
+  chunk->counts = count_obj_records(chunk->begin, chunk->end);
+}
+
+static void parse_obj_chunk_job(void* user_data, const int chunk_index) {
+  const obj_chunk_jobs_t* jobs = user_data;
+  const obj_chunk_t* chunk = &jobs->chunks[chunk_index];
+  parse_obj_records(chunk->begin, chunk->end, jobs->mesh, chunk->offset);
+}
+
+model_t load_obj_mesh_parallel(
+  const char* mesh_path, job_pool_t* pool, arena_t* arena) {
   model_t model = (model_t){.scale = (as_vec3f){1.0f, 1.0f, 1.0f}};
 
-  FILE* file = fopen(mesh_path, "r");
-
-  char buffer[128];
-  buffer[0] = '\0';
-
-  const char* separator = " ";
-  while (fgets(buffer, sizeof buffer, file) != NULL) {
-    char* line = buffer;
-    if (strncmp(line, "v ", 2) == 0) {
-      line += 2;
-      char* token = strtok(line, separator);
-      as_point3f vertex = {0};
-      float* vertices[] = {[0] = &vertex.x, [1] = &vertex.y, [2] = &vertex.z};
-      int i = 0;
-      while (token != NULL) {
-        *vertices[i++] = atof(token);
-        token = strtok(NULL, separator);
+  mapped_file_t file;
+  if (!mapped_file_open(&file, mesh_path)) {
+    printf("Failed to open mesh: %s\n", mesh_path);
+    return model;
+  }
+
+  // a few chunks per thread to even out differences in line density, but
+  // not so many that small files pay for scheduling
+  enum { min_chunk_size = 256 * 1024, chunks_per_thread = 4 };
+  const size_t max_chunk_count =
+    (size_t)job_pool_thread_count(pool) * chunks_per_thread;
+  size_t chunk_count = file.size / min_chunk_size;
+  chunk_count = chunk_count < 1                 ? 1
+              : chunk_count > max_chunk_count ? max_chunk_count
+                                                : chunk_count;
+
+  obj_chunk_t* chunks =
+    arena_alloc_array(arena, chunk_count, sizeof(obj_chunk_t));
+  const char* begin = file.data;
+  const char* end = file.data + file.size;
+  int used_chunk_count = 0;
+  for (const char* cursor = begin; cursor < end;) {
+    const char* chunk_end = end;
+    if ((size_t)used_chunk_count + 1 < chunk_count) {
+      const char* target =
+        begin + file.size / chunk_count * (size_t)(used_chunk_count + 1);
+      chunk_end = end_of_line(target > cursor ? target : cursor, end);
+      chunk_end = chunk_end < end ? chunk_end + 1 : end;
+    }
+    chunks[used_chunk_count++] =
+      (obj_chunk_t){.begin = cursor, .end = chunk_end};
+    cursor = chunk_end;
+  }
+
+  obj_chunk_jobs_t jobs = {.chunks = chunks, .mesh = &model.mesh};
+  job_pool_run(pool, used_chunk_count, count_obj_chunk_job, &jobs);
+
+  // prefix sum of the per chunk counts gives each chunk its output offset
+  // (and the element counts relative indices are resolved against)
+  obj_counts_t total = {0};
+  for (int c = 0; c < used_chunk_count; c++) {
+    chunks[c].offset = total;
+    total.vertex_count += chunks[c].counts.vertex_count;
+    total.uv_count += chunks[c].counts.uv_count;
+    total.face_count += chunks[c].counts.face_count;
+  }
+
+  allocate_mesh_arrays(&model.mesh, total, arena);
+  job_pool_run(pool, used_chunk_count, parse_obj_chunk_job, &jobs);
+
+  mapped_file_close(&file);
+  return model;
+}
+
+static uint32_t hash_corner(const uint64_t key) {
+  // 64 bit mix (murmur3 finalizer)
+  uint64_t hash = key;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+  return (uint32_t)hash;
+}
+
+// welded but not yet finalized buffers (32-bit indices into one table)
+typedef struct welded_mesh_t {
+  float* vertices;
+  float* uvs;
+  uint32_t* indices; // index lists of each lod one after another
+  int vertex_count;
+  int index_count; // of every lod
+  int lod_count;
+  int lod_index_counts[MaxMeshLodCount];
+  float lod_errors[MaxMeshLodCount];
+} welded_mesh_t;
+
+// every position index must be in [1, vertex_count] and every uv index in
+// [1, uv_count] or 0 (none), relative indices are resolved while parsing
+static bool valid_face(const mesh_t* mesh, const face_t* face) {
+  for (int v = 0; v < 3; v++) {
+    const int vertex_index = face->vert_indices[v];
+    const int uv_index = face->uv_indices[v];
+    if (
+      vertex_index < 1 || vertex_index > mesh->vertex_count || uv_index < 0
+      || uv_index > mesh->uv_count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// faces of a malformed obj with indices out of range are skipped
+static welded_mesh_t weld_mesh(const mesh_t* mesh, arena_t* scratch) {
+  const int corner_count = mesh->face_count * 3;
+
+  // open addressing table from (position index, uv index) to welded vertex,
+  // kept at most half full
+  uint32_t slot_count = 16;
+  while (slot_count < (uint32_t)corner_count * 2) {
+    slot_count <<= 1;
+  }
+  // 12 bytes without the padding a 64 bit key would add, the table is the
+  // largest import temporary
+  typedef struct corner_slot_t {
+    uint32_t vertex_index;
+    uint32_t uv_index;
+    int vertex;
+  } corner_slot_t;
+  const arena_mark_t mark = arena_mark(scratch);
+  corner_slot_t* slots =
+    arena_alloc_array(scratch, slot_count, sizeof(corner_slot_t));
+  for (uint32_t s = 0; s < slot_count; s++) {
+    slots[s].vertex = -1;
+  }
+
+  // sized for the worst case (no shared corners), trimmed below
+  welded_mesh_t welded = {
+    .vertices = array_hold(NULL, corner_count * 3, sizeof(float)),
+    .uvs = array_hold(NULL, corner_count * 2, sizeof(float)),
+    .indices = array_hold(NULL, corner_count, sizeof(uint32_t)),
+    .index_count = corner_count,
+    .lod_count = 1,
+    .lod_index_counts = {corner_count}};
+  int c = 0;
+  for (int f = 0; f < mesh->face_count; f++) {
+    if (!valid_face(mesh, &mesh->faces[f])) {
+      continue;
+    }
+    for (int v = 0; v < 3; v++, c++) {
+      const int vertex_index = mesh->faces[f].vert_indices[v] - 1;
+      const int uv_index = mesh->faces[f].uv_indices[v] - 1;
+      const uint64_t key =
+        ((uint64_t)(uint32_t)vertex_index << 32) | (uint32_t)uv_index;
+      uint32_t slot = hash_corner(key) & (slot_count - 1);
+      while (slots[slot].vertex != -1
+             && (slots[slot].vertex_index != (uint32_t)vertex_index
+                 || slots[slot].uv_index != (uint32_t)uv_index)) {
+        slot = (slot + 1) & (slot_count - 1);
+      }
+      if (slots[slot].vertex == -1) {
+        const int w = welded.vertex_count++;
+        slots[slot] = (corner_slot_t){
+          .vertex_index = (uint32_t)vertex_index,
+          .uv_index = (uint32_t)uv_index,
+          .vertex = w};
+        welded.vertices[w * 3 + 0] = mesh->vertices[vertex_index].x;
+        welded.vertices[w * 3 + 1] = mesh->vertices[vertex_index].y;
+        welded.vertices[w * 3 + 2] = mesh->vertices[vertex_index].z;
+        // uvs flipped vertically for sampling
+        const tex2f_t uv =
+          uv_index >= 0 ? mesh->uvs[uv_index] : (tex2f_t){0};
+        welded.uvs[w * 2 + 0] = uv.u;
+        welded.uvs[w * 2 + 1] = 1.0f - uv.v;
       }
-      array_push(model.mesh.vertices, vertex);
-    } else if (strncmp(line, "vt ", 3) == 0) {
-      line += 3;
-      char* token = strtok(line, separator);
-      tex2f_t uv = {0};
-      float* uvs[] = {[0] = &uv.u, [1] = &uv.v};
-      int i = 0;
-      while (token != NULL) {
-        *uvs[i++] = atof(token);
-        token = strtok(NULL, separator);
+      welded.indices[c] = (uint32_t)slots[slot].vertex;
+    }
+  }
+  arena_rewind(scratch, mark);
+  if (c < corner_count) {
+    printf(
+      "Skipped %d face(s) with indices out of range\n",
+      (corner_count - c) / 3);
+    welded.indices = array_shrink(welded.indices, c, sizeof(uint32_t));
+    welded.index_count = c;
+    welded.lod_index_counts[0] = c;
+  }
+
+  welded.vertices =
+    array_shrink(welded.vertices, welded.vertex_count * 3, sizeof(float));
+  welded.uvs = array_shrink(welded.uvs, welded.vertex_count * 2, sizeof(float));
+  return welded;
+}
+
+// splits the triangle list of each lod into consecutive submeshes
+// referencing at most 65536 vertices each, vertices shared across a split
+// (or by several lods) are duplicated
+static mesh_buffers_t split_16bit_submeshes(
+  const welded_mesh_t* welded, arena_t* scratch) {
+  // every welded vertex is used at least once, duplicates grow the arrays
+  float* vertices =
+    array_reserve(NULL, (size_t)welded->vertex_count * 3, sizeof(float));
+  float* uvs =
+    array_reserve(NULL, (size_t)welded->vertex_count * 2, sizeof(float));
+  uint16_t* indices = array_hold(NULL, welded->index_count, sizeof(uint16_t));
+  submesh_t* submeshes = NULL;
+  mesh_lod_t* lods = array_hold(NULL, welded->lod_count, sizeof(mesh_lod_t));
+
+  // local index of each welded vertex in the current submesh (-1 if absent)
+  const arena_mark_t mark = arena_mark(scratch);
+  int* local_indices =
+    arena_alloc_array(scratch, welded->vertex_count, sizeof(int));
+  for (int v = 0; v < welded->vertex_count; v++) {
+    local_indices[v] = -1;
+  }
+  // welded vertices referenced by the current submesh
+  uint32_t* submesh_vertices =
+    arena_alloc_array(scratch, Max16BitVertexCount, sizeof(uint32_t));
+
+  int vertex_count = 0;
+  for (int l = 0, lod_begin = 0; l < welded->lod_count; l++) {
+    const int lod_end = lod_begin + welded->lod_index_counts[l];
+    lods[l] = (mesh_lod_t){
+      .submesh_offset = array_length(submeshes),
+      .triangle_count = welded->lod_index_counts[l] / 3,
+      .error = welded->lod_errors[l]};
+    submesh_t submesh = {
+      .index_offset = lod_begin, .vertex_offset = vertex_count};
+    for (int i = lod_begin; i < lod_end; i += 3) {
+      const uint32_t* triangle = &welded->indices[i];
+      int new_vertex_count = 0;
+      for (int c = 0; c < 3; c++) {
+        new_vertex_count += local_indices[triangle[c]] == -1
+                         && (c < 1 || triangle[c] != triangle[0])
+                         && (c < 2 || triangle[c] != triangle[1]);
       }
-      array_push(model.mesh.uvs, uv);
-    } else if (strncmp(line, "f ", 2) == 0) {
-      line += 2;
-      char* token = strtok(line, separator);
-      face_t face = {0};
-      int v = 0;
-      int uv = 0;
-      while (token != NULL) {
-        {
-          const char* slash = strchr(token, '/');
-          const int len = slash - token;
-          char temp[32];
-          memcpy(temp, token, len);
-          temp[len] = '\0';
-          face.vert_indices[v++] = atoi(temp);
-          token += len + 1;
+      if (submesh.vertex_count + new_vertex_count > Max16BitVertexCount) {
+        for (int v = 0; v < submesh.vertex_count; v++) {
+          local_indices[submesh_vertices[v]] = -1;
         }
-        {
-          const char* slash = strchr(token, '/');
-          const int len = slash - token;
-          char temp[32];
-          memcpy(temp, token, len);
-          temp[len] = '\0';
-          face.uv_indices[uv++] = atoi(temp);
+        array_push(submeshes, submesh);
+        submesh = (submesh_t){
+          .index_offset = i, .vertex_offset = vertex_count};
+      }
+      for (int c = 0; c < 3; c++) {
+        const uint32_t w = triangle[c];
+        if (local_indices[w] == -1) {
+          local_indices[w] = submesh.vertex_count;
+          submesh_vertices[submesh.vertex_count++] = w;
+          array_extend(vertices, &welded->vertices[w * 3], 3);
+          array_extend(uvs, &welded->uvs[w * 2], 2);
+          vertex_count++;
         }
-        token = strtok(NULL, separator);
+        indices[i + c] = (uint16_t)local_indices[w];
       }
-      array_push(model.mesh.faces, face);
+      submesh.index_count += 3;
     }
+    for (int v = 0; v < submesh.vertex_count; v++) {
+      local_indices[submesh_vertices[v]] = -1;
+    }
+    if (submesh.index_count > 0) {
+      array_push(submeshes, submesh);
+    }
+    lods[l].submesh_count = array_length(submeshes) - lods[l].submesh_offset;
+    lod_begin = lod_end;
   }
-  fclose(file);
-  return model;
+  arena_rewind(scratch, mark);
+
+  return (mesh_buffers_t){
+    .vertices = vertices,
+    .uvs = uvs,
+    .indices = indices,
+    .submeshes = submeshes,
+    .lods = lods,
+    .vertex_count = vertex_count,
+    .index_count = welded->index_count,
+    .index_size = sizeof(uint16_t),
+    .submesh_count = array_length(submeshes),
+    .lod_count = welded->lod_count};
+}
+
+// picks the smallest index type able to address every vertex, meshes too
+// large for 16-bit indices are optionally split instead of using 32-bit
+static mesh_buffers_t finalize_mesh_buffers(
+  welded_mesh_t* welded, const mesh_import_options_t* options,
+  arena_t* scratch) {
+  if (
+    welded->vertex_count > Max16BitVertexCount
+    && options->split_16bit_submeshes) {
+    mesh_buffers_t buffers = split_16bit_submeshes(welded, scratch);
+    array_free(welded->vertices);
+    array_free(welded->uvs);
+    array_free(welded->indices);
+    return buffers;
+  }
+
+  // one submesh per lod, all using the whole vertex buffer
+  submesh_t* submeshes =
+    array_hold(NULL, welded->lod_count, sizeof(submesh_t));
+  mesh_lod_t* lods = array_hold(NULL, welded->lod_count, sizeof(mesh_lod_t));
+  for (int l = 0, index_offset = 0; l < welded->lod_count; l++) {
+    submeshes[l] = (submesh_t){
+      .index_offset = index_offset,
+      .index_count = welded->lod_index_counts[l],
+      .vertex_count = welded->vertex_count};
+    lods[l] = (mesh_lod_t){
+      .submesh_offset = l,
+      .submesh_count = 1,
+      .triangle_count = welded->lod_index_counts[l] / 3,
+      .error = welded->lod_errors[l]};
+    index_offset += welded->lod_index_counts[l];
+  }
+  mesh_buffers_t buffers = {
+    .vertices = welded->vertices,
+    .uvs = welded->uvs,
+    .submeshes = submeshes,
+    .lods = lods,
+    .vertex_count = welded->vertex_count,
+    .index_count = welded->index_count,
+    .submesh_count = welded->lod_count,
+    .lod_count = welded->lod_count};
+  if (welded->vertex_count <= Max16BitVertexCount) {
+    uint16_t* indices = array_hold(NULL, welded->index_count, sizeof(uint16_t));
+    for (int i = 0; i < welded->index_count; i++) {
+      indices[i] = (uint16_t)welded->indices[i];
+    }
+    array_free(welded->indices);
+    buffers.indices = indices;
+    buffers.index_size = sizeof(uint16_t);
+  } else {
+    buffers.indices = welded->indices;
+    buffers.index_size = sizeof(uint32_t);
+  }
+  return buffers;
+}
+
+static void print_mesh_buffers_memory(
+  const int corner_count, const int welded_vertex_count,
+  const mesh_buffers_t* buffers) {
+  const int vertex_size = 5 * sizeof(float);
+  const int index_bytes = buffers->index_count * buffers->index_size;
+  // compared to one vertex per face corner (with the same index type)
+  printf(
+    "Welded %d corners into %d vertices (%.1f%%), %d bytes -> %d bytes\n",
+    corner_count, welded_vertex_count,
+    corner_count > 0 ? 100.0 * welded_vertex_count / corner_count : 100.0,
+    corner_count * vertex_size + index_bytes,
+    welded_vertex_count * vertex_size + index_bytes);
+  printf(
+    "Index buffer: %d-bit, %d submesh(es), %d vertex bytes + %d index bytes\n",
+    buffers->index_size * 8, buffers->submesh_count,
+    buffers->vertex_count * vertex_size, index_bytes);
+  if (buffers->submesh_count > buffers->lod_count) {
+    // what a single submesh with 32-bit indices would have needed instead
+    printf(
+      "  32-bit alternative: %d vertex bytes + %d index bytes\n",
+      welded_vertex_count * vertex_size,
+      buffers->index_count * (int)sizeof(uint32_t));
+  }
+}
+
+static void print_vertex_cache_stats(
+  const char* label, const welded_mesh_t* welded, arena_t* scratch) {
+  const vertex_cache_stats_t stats = analyze_vertex_cache(
+    welded->indices, welded->index_count, welded->vertex_count,
+    VertexCacheAnalysisSize, scratch);
+  printf(
+    "Vertex cache %s: ACMR %.3f, ATVR %.3f (%d entry fifo)\n", label,
+    stats.acmr, stats.atvr, VertexCacheAnalysisSize);
+}
+
+// reorders triangles for the post-transform cache, then vertices in the
+// order the new triangle order first fetches them
+static void optimize_welded_mesh(welded_mesh_t* welded, arena_t* scratch) {
+  print_vertex_cache_stats("before", welded, scratch);
+  optimize_vertex_cache(
+    welded->indices, welded->index_count, welded->vertex_count, scratch);
+
+  const arena_mark_t mark = arena_mark(scratch);
+  int* remap = arena_alloc_array(scratch, welded->vertex_count, sizeof(int));
+  const int vertex_count = optimize_vertex_fetch_remap(
+    welded->indices, welded->index_count, welded->vertex_count, remap);
+  float* vertices = array_hold(NULL, vertex_count * 3, sizeof(float));
+  float* uvs = array_hold(NULL, vertex_count * 2, sizeof(float));
+  for (int v = 0; v < welded->vertex_count; v++) {
+    const int r = remap[v];
+    if (r < 0) {
+      continue;
+    }
+    memcpy(&vertices[r * 3], &welded->vertices[v * 3], 3 * sizeof(float));
+    memcpy(&uvs[r * 2], &welded->uvs[v * 2], 2 * sizeof(float));
+  }
+  arena_rewind(scratch, mark);
+  array_free(welded->vertices);
+  array_free(welded->uvs);
+  welded->vertices = vertices;
+  welded->uvs = uvs;
+  welded->vertex_count = vertex_count;
+  print_vertex_cache_stats("after", welded, scratch);
+}
+
+// appends up to lod_count - 1 levels of detail, each simplified from lod 0
+// to half the triangles of the previous level (stops early once the mesh
+// can not be simplified any further)
+static void generate_lods(
+  welded_mesh_t* welded, const int lod_count, const bool optimize,
+  arena_t* scratch) {
+  const int base_index_count = welded->lod_index_counts[0];
+  const arena_mark_t mark = arena_mark(scratch);
+  uint32_t* lod_indices =
+    arena_alloc_array(scratch, base_index_count, sizeof(uint32_t));
+  int target_index_count = base_index_count;
+  while (welded->lod_count < lod_count && welded->lod_count < MaxMeshLodCount) {
+    target_index_count = target_index_count / 6 * 3;
+    float error;
+    const int index_count = simplify_mesh(
+      lod_indices, welded->indices, base_index_count, welded->vertices,
+      welded->vertex_count, target_index_count, &error, scratch);
+    if (
+      index_count == 0
+      || index_count >= welded->lod_index_counts[welded->lod_count - 1]) {
+      break;
+    }
+    if (optimize) {
+      optimize_vertex_cache(
+        lod_indices, index_count, welded->vertex_count, scratch);
+    }
+    welded->indices =
+      array_hold(welded->indices, index_count, sizeof(uint32_t));
+    memcpy(
+      &welded->indices[welded->index_count], lod_indices,
+      index_count * sizeof(uint32_t));
+    welded->index_count += index_count;
+    welded->lod_index_counts[welded->lod_count] = index_count;
+    welded->lod_errors[welded->lod_count] = error;
+    welded->lod_count++;
+  }
+  arena_rewind(scratch, mark);
+}
+
+static void print_lods(const welded_mesh_t* welded) {
+  for (int l = 0; l < welded->lod_count; l++) {
+    printf(
+      "LOD %d: %d triangles (%.1f%%), error %g\n", l,
+      welded->lod_index_counts[l] / 3,
+      100.0 * welded->lod_index_counts[l] / welded->lod_index_counts[0],
+      welded->lod_errors[l]);
+  }
+}
+
+// reorders the triangles of every submesh into meshlets, each submesh
+// references its own range of the meshlets
+static void build_submesh_meshlets(mesh_buffers_t* buffers, arena_t* scratch) {
+  meshlet_t* meshlets = NULL;
+  submesh_t* submeshes = (submesh_t*)buffers->submeshes;
+  int max_index_count = 0;
+  for (int s = 0; s < buffers->submesh_count; s++) {
+    if (submeshes[s].index_count > max_index_count) {
+      max_index_count = submeshes[s].index_count;
+    }
+  }
+  // 32-bit copy of the submesh indices (relative to the submesh vertices)
+  const arena_mark_t mark = arena_mark(scratch);
+  uint32_t* submesh_indices =
+    arena_alloc_array(scratch, max_index_count, sizeof(uint32_t));
+  for (int s = 0; s < buffers->submesh_count; s++) {
+    submesh_t* submesh = &submeshes[s];
+    if (buffers->index_size == sizeof(uint16_t)) {
+      const uint16_t* indices =
+        (const uint16_t*)buffers->indices + submesh->index_offset;
+      for (int i = 0; i < submesh->index_count; i++) {
+        submesh_indices[i] = indices[i];
+      }
+    } else {
+      memcpy(
+        submesh_indices,
+        (const uint32_t*)buffers->indices + submesh->index_offset,
+        submesh->index_count * sizeof(uint32_t));
+    }
+    submesh->meshlet_offset = array_length(meshlets);
+    meshlets = build_meshlets(
+      meshlets, submesh_indices, submesh->index_count,
+      &buffers->vertices[submesh->vertex_offset * 3], submesh->vertex_count,
+      submesh->index_offset, scratch);
+    submesh->meshlet_count = array_length(meshlets) - submesh->meshlet_offset;
+    if (buffers->index_size == sizeof(uint16_t)) {
+      uint16_t* indices = (uint16_t*)buffers->indices + submesh->index_offset;
+      for (int i = 0; i < submesh->index_count; i++) {
+        indices[i] = (uint16_t)submesh_indices[i];
+      }
+    } else {
+      memcpy(
+        (uint32_t*)buffers->indices + submesh->index_offset, submesh_indices,
+        submesh->index_count * sizeof(uint32_t));
+    }
+  }
+  arena_rewind(scratch, mark);
+  buffers->meshlets = meshlets;
+  buffers->meshlet_count = array_length(meshlets);
+}
+
+static void print_meshlets(const mesh_buffers_t* buffers) {
+  for (int l = 0; l < buffers->lod_count; l++) {
+    const mesh_lod_t* lod = &buffers->lods[l];
+    int meshlet_count = 0;
+    for (int s = lod->submesh_offset;
+         s < lod->submesh_offset + lod->submesh_count; s++) {
+      meshlet_count += buffers->submeshes[s].meshlet_count;
+    }
+    printf(
+      "LOD %d: %d meshlets, %.1f triangles per meshlet (at most %d)\n", l,
+      meshlet_count,
+      meshlet_count > 0 ? (double)lod->triangle_count / meshlet_count : 0.0,
+      MaxMeshletTriangleCount);
+  }
+}
+
+static void quantize_mesh_buffers(mesh_buffers_t* buffers) {
+  const int vertex_count = buffers->vertex_count;
+  quantized_vertices_t quantized = {0};
+  for (int a = 0; a < 3; a++) {
+    float min = FLT_MAX;
+    float max = -FLT_MAX;
+    for (int v = 0; v < vertex_count; v++) {
+      const float p = buffers->vertices[v * 3 + a];
+      min = p < min ? p : min;
+      max = p > max ? p : max;
+    }
+    quantized.position_offset[a] = vertex_count > 0 ? (min + max) * 0.5f : 0.0f;
+    quantized.position_scale[a] =
+      vertex_count > 0 && max > min ? (max - min) * 0.5f : 1.0f;
+  }
+
+  int16_t* positions = array_hold(NULL, vertex_count * 4, sizeof(int16_t));
+  uint16_t* uvs = array_hold(NULL, vertex_count * 2, sizeof(uint16_t));
+  for (int v = 0; v < vertex_count; v++) {
+    for (int a = 0; a < 3; a++) {
+      const float p = buffers->vertices[v * 3 + a];
+      const float offset = quantized.position_offset[a];
+      const float scale = quantized.position_scale[a];
+      const int16_t q = snorm16_from_float((p - offset) / scale);
+      positions[v * 4 + a] = q;
+      const float error = fabsf(offset + scale * float_from_snorm16(q) - p);
+      if (error > quantized.max_position_error) {
+        quantized.max_position_error = error;
+      }
+    }
+    positions[v * 4 + 3] = snorm16_from_float(1.0f);
+    for (int a = 0; a < 2; a++) {
+      const float uv = buffers->uvs[v * 2 + a];
+      const uint16_t h = half_from_float(uv);
+      uvs[v * 2 + a] = h;
+      const float error = fabsf(float_from_half(h) - uv);
+      if (error > quantized.max_uv_error) {
+        quantized.max_uv_error = error;
+      }
+    }
+  }
+  quantized.positions = positions;
+  quantized.uvs = uvs;
+  buffers->quantized = quantized;
+}
+
+static void print_quantized_vertices(const mesh_buffers_t* buffers) {
+  const quantized_vertices_t* quantized = &buffers->quantized;
+  const float largest_scale = fmaxf(
+    quantized->position_scale[0],
+    fmaxf(quantized->position_scale[1], quantized->position_scale[2]));
+  const int vertex_size = 5 * sizeof(float);
+  const int quantized_vertex_size = 4 * sizeof(int16_t) + 2 * sizeof(uint16_t);
+  printf(
+    "Quantized vertices: %d bytes -> %d bytes, max position error %g "
+    "(%.5f%% of bounds), max uv error %g\n",
+    buffers->vertex_count * vertex_size,
+    buffers->vertex_count * quantized_vertex_size,
+    quantized->max_position_error,
+    100.0f * quantized->max_position_error / (2.0f * largest_scale),
+    quantized->max_uv_error);
+}
+
+mesh_buffers_t build_mesh_buffers(
+  const mesh_t* mesh, const mesh_import_options_t* options, arena_t* scratch) {
+  welded_mesh_t welded = weld_mesh(mesh, scratch);
+  const int corner_count = welded.index_count;
+  if (options->optimize_vertex_cache) {
+    optimize_welded_mesh(&welded, scratch);
+  }
+  if (options->lod_count > 1) {
+    generate_lods(
+      &welded, options->lod_count, options->optimize_vertex_cache, scratch);
+    print_lods(&welded);
+  }
+  const int welded_vertex_count = welded.vertex_count;
+  mesh_buffers_t buffers = finalize_mesh_buffers(&welded, options, scratch);
+  print_mesh_buffers_memory(corner_count, welded_vertex_count, &buffers);
+  if (options->build_meshlets) {
+    build_submesh_meshlets(&buffers, scratch);
+    print_meshlets(&buffers);
+  }
+  if (options->quantize_vertices) {
+    quantize_mesh_buffers(&buffers);
+    print_quantized_vertices(&buffers);
+  }
+  return buffers;
+}
+
+void free_mesh_buffers(mesh_buffers_t* buffers) {
+  if (buffers->cache_file.data != NULL) {
+    mapped_file_close(&buffers->cache_file);
+  } else {
+    array_free((void*)buffers->vertices);
+    array_free((void*)buffers->uvs);
+    array_free((void*)buffers->indices);
+    array_free((void*)buffers->submeshes);
+    array_free((void*)buffers->lods);
+    array_free((void*)buffers->meshlets);
+    array_free((void*)buffers->quantized.positions);
+    array_free((void*)buffers->quantized.uvs);
+  }
+  *buffers = (mesh_buffers_t){0};
+}
+
+static double elapsed_ms(const uint64_t begin_counter) {
+  return (double)(SDL_GetPerformanceCounter() - begin_counter) * 1000.0
+       / (double)SDL_GetPerformanceFrequency();
+}
+
+// smallest block of the import arena, obj records and welding temporaries
+// of larger meshes get blocks of their own size
+#define ImportArenaBlockSize (1024 * 1024)
+
+static void print_import_scratch(const arena_t* scratch) {
+  printf(
+    "Import scratch: %.2f MB in %d allocations, %d block(s) malloc'd\n",
+    (double)scratch->used / (1024.0 * 1024.0), scratch->allocation_count,
+    scratch->block_allocation_count);
+}
+
+typedef struct texture_decode_t {
+  const char* texture_path;
+  const texture_import_options_t* options;
+  job_pool_t* pool;
+  texture_t texture;
+  double decode_ms;
+} texture_decode_t;
+
+static int decode_texture_thread(void* data) {
+  texture_decode_t* decode = data;
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+  decode->texture =
+    load_png_texture(decode->texture_path, decode->options, decode->pool);
+  decode->decode_ms = elapsed_ms(begin_counter);
+  return 0;
 }
 
 model_t load_obj_mesh_with_png_texture(
-  const char* mesh_path, const char* texture_path) {
-  model_t model = load_obj_mesh(mesh_path);
-  model.texture = load_png_texture(texture_path);
+  const char* mesh_path, const char* texture_path,
+  const mesh_import_options_t* options,
+  const texture_import_options_t* texture_options, job_pool_t* pool) {
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+
+  // the texture is independent of the mesh, decode it alongside
+  texture_decode_t texture_decode = {
+    .texture_path = texture_path, .options = texture_options, .pool = pool};
+  SDL_Thread* texture_thread =
+    SDL_CreateThread(decode_texture_thread, "png-decode", &texture_decode);
+
+  char cache_path[1024];
+  mesh_cache_path(mesh_path, cache_path, sizeof cache_path);
+  // taken before the obj is read, the cache is skipped without it
+  file_stamp_t source_stamp;
+  const bool stamped = file_stamp(mesh_path, &source_stamp);
+
+  model_t model;
+  double import_ms;
+  mesh_buffers_t cached_buffers;
+  if (
+    stamped
+    && mesh_cache_load(
+      cache_path, &source_stamp, options, &cached_buffers, &import_ms)) {
+    model = (model_t){
+      .buffers = cached_buffers, .scale = (as_vec3f){1.0f, 1.0f, 1.0f}};
+    printf(
+      "Loaded %s in %.2fms (import without cache: %.2fms)\n", cache_path,
+      elapsed_ms(begin_counter), import_ms);
+  } else {
+    // everything but the buffers is released in one go
+    arena_t scratch = arena_create(ImportArenaBlockSize);
+    model = pool != NULL ? load_obj_mesh_parallel(mesh_path, pool, &scratch)
+                         : load_obj_mesh(mesh_path, &scratch);
+    model.buffers = build_mesh_buffers(&model.mesh, options, &scratch);
+    print_import_scratch(&scratch);
+    arena_free(&scratch);
+    model.mesh = (mesh_t){0};
+    import_ms = elapsed_ms(begin_counter);
+    if (
+      stamped
+      && !mesh_cache_save(
+        cache_path, &source_stamp, options, &model.buffers, import_ms)) {
+      printf("Failed to write mesh cache: %s\n", cache_path);
+    }
+    printf("Imported %s in %.2fms\n", mesh_path, import_ms);
+  }
+
+  if (texture_thread != NULL) {
+    SDL_WaitThread(texture_thread, NULL);
+  } else {
+    decode_texture_thread(&texture_decode);
+  }
+  model.texture = texture_decode.texture;
+  printf(
+    "Decoded %s in %.2fms, model ready in %.2fms\n", texture_path,
+    texture_decode.decode_ms, elapsed_ms(begin_counter));
   return model;
 }
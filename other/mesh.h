@@ -1,27 +1,136 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include "arena.h"
+#include "mapped_file.h"
+#include "meshlet.h"
 #include "texture.h"
 #include "triangle.h"
 
 #include <as-ops.h>
+#include <stdbool.h>
+#include <stdint.h>
 
+typedef struct job_pool_t job_pool_t;
+
+// obj records, allocated from the arena the mesh was loaded with
 typedef struct mesh_t {
   as_point3f* vertices;
   tex2f_t* uvs;
   face_t* faces;
+  int vertex_count;
+  int uv_count;
+  int face_count;
 } mesh_t;
 
+// range of the index buffer drawn with the vertex buffers offset by
+// vertex_offset (indices are relative to the start of the submesh vertices),
+// split into meshlet_count meshlets when imported with build_meshlets
+typedef struct submesh_t {
+  int index_offset;
+  int index_count;
+  int vertex_offset;
+  int vertex_count;
+  int meshlet_offset;
+  int meshlet_count;
+} submesh_t;
+
+// most levels of detail a mesh can have (including the full mesh)
+#define MaxMeshLodCount 8
+
+// level of detail, a range of submeshes drawn instead of the full mesh (lod
+// 0), error is the largest simplification error in model units
+typedef struct mesh_lod_t {
+  int submesh_offset;
+  int submesh_count;
+  int triangle_count;
+  float error;
+} mesh_lod_t;
+
+// compact copy of the vertex streams for the gpu, positions are normalized
+// 16-bit integers (x, y, z and w = 1) relative to the mesh bounds and uvs
+// are half floats, position_offset + position_scale * p restores a position
+typedef struct quantized_vertices_t {
+  const int16_t* positions; // 4 per vertex (SG_VERTEXFORMAT_SHORT4N)
+  const uint16_t* uvs; // 2 per vertex (SG_VERTEXFORMAT_HALF2)
+  float position_offset[3];
+  float position_scale[3];
+  // largest difference to the float streams (per component)
+  float max_position_error;
+  float max_uv_error;
+} quantized_vertices_t;
+
+// gpu ready vertex and index streams, either owned arrays (see array.h) or
+// pointers into a memory mapped mesh cache
+typedef struct mesh_buffers_t {
+  const float* vertices; // xyz per vertex
+  const float* uvs; // uv per vertex (v flipped for sampling)
+  const void* indices; // uint16_t or uint32_t (see index_size)
+  const submesh_t* submeshes;
+  const mesh_lod_t* lods; // finest first
+  const meshlet_t* meshlets; // NULL unless imported with build_meshlets
+  int vertex_count;
+  int index_count;
+  int index_size;
+  int submesh_count;
+  int lod_count;
+  int meshlet_count;
+  // positions are NULL unless imported with quantize_vertices
+  quantized_vertices_t quantized;
+  mapped_file_t cache_file;
+} mesh_buffers_t;
+
+typedef struct mesh_import_options_t {
+  // meshes with more vertices than 16-bit indices can address are split
+  // into several submeshes instead of switching to 32-bit indices
+  bool split_16bit_submeshes;
+  // reorders triangles and vertices for post-transform cache and vertex
+  // fetch locality (the rendered result is unchanged)
+  bool optimize_vertex_cache;
+  // adds quantized_vertices_t streams (the float streams are still used for
+  // cpu work such as projection)
+  bool quantize_vertices;
+  // levels of detail to generate (up to MaxMeshLodCount, including the full
+  // mesh), each with about half the triangles of the previous one
+  int lod_count;
+  // reorders the triangles of each submesh into meshlets (see meshlet.h)
+  // with bounds for culling clusters smaller than the whole mesh
+  bool build_meshlets;
+} mesh_import_options_t;
+
 typedef struct model_t {
   mesh_t mesh;
+  mesh_buffers_t buffers;
   texture_t texture;
   as_vec3f rotation;
   as_vec3f scale;
   as_vec3f translation;
 } model_t;
 
-model_t load_obj_mesh(const char* mesh_path);
+// the mesh arrays are allocated from arena (released with it, they are
+// import temporaries only needed until build_mesh_buffers)
+model_t load_obj_mesh(const char* mesh_path, arena_t* arena);
+// splits the file into newline aligned chunks parsed across the pool,
+// the result is identical to load_obj_mesh
+model_t load_obj_mesh_parallel(
+  const char* mesh_path, job_pool_t* pool, arena_t* arena);
+// returns the model with buffers populated and mesh arrays released,
+// buffers come from a binary cache next to the mesh (extension .smesh)
+// when it is up to date, otherwise the mesh is imported and the cache is
+// (re)written, pool is optional (NULL loads the mesh on the calling thread)
+// the texture is decoded (and block compressed, see texture_import_options_t)
+// on its own thread while the mesh loads
 model_t load_obj_mesh_with_png_texture(
-  const char* mesh_path, const char* texture_path);
+  const char* mesh_path, const char* texture_path,
+  const mesh_import_options_t* options,
+  const texture_import_options_t* texture_options, job_pool_t* pool);
+
+// welds face corners sharing a position and uv into a single vertex,
+// optionally optimizes the vertex order, generates levels of detail and
+// builds meshlets, and selects the index type (see mesh_import_options_t),
+// temporaries are allocated from scratch
+mesh_buffers_t build_mesh_buffers(
+  const mesh_t* mesh, const mesh_import_options_t* options, arena_t* scratch);
+void free_mesh_buffers(mesh_buffers_t* buffers);
 
 #endif // MESH_H
@@ -0,0 +1,316 @@
+#include "mesh_cache.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// bump whenever the layout or contents of the cache change
+#define MeshCacheVersion 6
+#define MeshCacheAlignment 16
+
+static const char g_mesh_cache_magic[4] = {'S', 'M', 'S', 'H'};
+
+typedef struct mesh_cache_header_t {
+  char magic[4];
+  uint32_t version;
+  // revision of the source the cache was built from
+  uint64_t source_size;
+  int64_t source_mtime;
+  // import options the cache was built with (see import_options_key)
+  uint32_t import_options;
+  uint32_t index_size;
+  // time the import took, reported when the cache is used instead
+  double import_ms;
+  uint32_t vertex_count;
+  uint32_t index_count;
+  uint32_t submesh_count;
+  // non zero when the quantized streams are present
+  uint32_t quantized;
+  uint32_t lod_count;
+  uint32_t meshlet_count;
+  uint64_t vertices_offset;
+  uint64_t uvs_offset;
+  uint64_t indices_offset;
+  uint64_t submeshes_offset;
+  uint64_t lods_offset;
+  uint64_t meshlets_offset;
+  uint64_t quantized_positions_offset;
+  uint64_t quantized_uvs_offset;
+  float position_offset[3];
+  float position_scale[3];
+  float max_position_error;
+  float max_uv_error;
+} mesh_cache_header_t;
+
+static uint32_t import_options_key(const mesh_import_options_t* options) {
+  return (options->split_16bit_submeshes ? 1u : 0u)
+       | (options->optimize_vertex_cache ? 2u : 0u)
+       | (options->quantize_vertices ? 4u : 0u)
+       | (options->build_meshlets ? 8u : 0u)
+       | (uint32_t)(options->lod_count > 1 ? options->lod_count : 1) << 4;
+}
+
+typedef struct mesh_cache_sizes_t {
+  uint64_t vertices;
+  uint64_t uvs;
+  uint64_t indices;
+  uint64_t submeshes;
+  uint64_t lods;
+  uint64_t meshlets;
+  uint64_t quantized_positions;
+  uint64_t quantized_uvs;
+} mesh_cache_sizes_t;
+
+static mesh_cache_sizes_t stream_sizes(const mesh_cache_header_t* header) {
+  return (mesh_cache_sizes_t){
+    .vertices = (uint64_t)header->vertex_count * 3 * sizeof(float),
+    .uvs = (uint64_t)header->vertex_count * 2 * sizeof(float),
+    .indices = (uint64_t)header->index_count * header->index_size,
+    .submeshes = (uint64_t)header->submesh_count * sizeof(submesh_t),
+    .lods = (uint64_t)header->lod_count * sizeof(mesh_lod_t),
+    .meshlets = (uint64_t)header->meshlet_count * sizeof(meshlet_t),
+    .quantized_positions =
+      header->quantized != 0
+        ? (uint64_t)header->vertex_count * 4 * sizeof(int16_t)
+        : 0,
+    .quantized_uvs =
+      header->quantized != 0
+        ? (uint64_t)header->vertex_count * 2 * sizeof(uint16_t)
+        : 0};
+}
+
+static uint64_t align_offset(const uint64_t offset) {
+  const uint64_t mask = MeshCacheAlignment - 1;
+  return (offset + mask) & ~mask;
+}
+
+// offsets and sizes come from the file, they are compared without adding
+// them (a corrupt file could overflow the sum)
+static bool stream_in_file(
+  const uint64_t offset, const uint64_t size, const size_t file_size) {
+  return offset % MeshCacheAlignment == 0 && offset <= file_size
+      && size <= file_size - offset;
+}
+
+static bool range_within(const int offset, const int count, const int total) {
+  return offset >= 0 && count >= 0 && offset <= total
+      && count <= total - offset;
+}
+
+// the submeshes, lods and meshlets of a corrupt or stale cache could send
+// draws, culling and the projection past the streams, every range and
+// index is checked before the cache is used
+static bool valid_ranges(const mesh_buffers_t* buffers) {
+  for (int s = 0; s < buffers->submesh_count; s++) {
+    const submesh_t* submesh = &buffers->submeshes[s];
+    if (
+      !range_within(
+        submesh->index_offset, submesh->index_count, buffers->index_count)
+      || submesh->index_count % 3 != 0
+      || !range_within(
+        submesh->vertex_offset, submesh->vertex_count, buffers->vertex_count)
+      || !range_within(
+        submesh->meshlet_offset, submesh->meshlet_count,
+        buffers->meshlet_count)) {
+      return false;
+    }
+    // indices are relative to the first vertex of the submesh
+    const uint32_t vertex_count = (uint32_t)submesh->vertex_count;
+    for (int i = submesh->index_offset;
+         i < submesh->index_offset + submesh->index_count; i++) {
+      const uint32_t index =
+        buffers->index_size == sizeof(uint16_t)
+          ? ((const uint16_t*)buffers->indices)[i]
+          : ((const uint32_t*)buffers->indices)[i];
+      if (index >= vertex_count) {
+        return false;
+      }
+    }
+    // meshlets are drawn with the vertices of their submesh
+    for (int m = submesh->meshlet_offset;
+         m < submesh->meshlet_offset + submesh->meshlet_count; m++) {
+      const meshlet_t* meshlet = &buffers->meshlets[m];
+      if (
+        meshlet->index_offset < submesh->index_offset
+        || !range_within(
+          meshlet->index_offset - submesh->index_offset, meshlet->index_count,
+          submesh->index_count)) {
+        return false;
+      }
+    }
+  }
+  for (int l = 0; l < buffers->lod_count; l++) {
+    const mesh_lod_t* lod = &buffers->lods[l];
+    if (!range_within(
+          lod->submesh_offset, lod->submesh_count, buffers->submesh_count)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void mesh_cache_path(
+  const char* source_path, char* cache_path, const int size) {
+  const char* extension = strrchr(source_path, '.');
+  const char* separator = strrchr(source_path, '/');
+  const int stem_length =
+    extension != NULL && (separator == NULL || extension > separator)
+      ? (int)(extension - source_path)
+      : (int)strlen(source_path);
+  snprintf(cache_path, size, "%.*s.smesh", stem_length, source_path);
+}
+
+bool mesh_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mesh_import_options_t* options, mesh_buffers_t* buffers,
+  double* import_ms) {
+  mapped_file_t file;
+  if (!mapped_file_open(&file, cache_path)) {
+    return false;
+  }
+
+  mesh_cache_header_t header;
+  if (file.size < sizeof header) {
+    mapped_file_close(&file);
+    return false;
+  }
+  memcpy(&header, file.data, sizeof header);
+
+  const mesh_cache_sizes_t sizes = stream_sizes(&header);
+  if (
+    memcmp(header.magic, g_mesh_cache_magic, sizeof header.magic) != 0
+    || header.version != MeshCacheVersion
+    || header.source_size != source_stamp->size
+    || header.source_mtime != source_stamp->mtime
+    || header.import_options != import_options_key(options)
+    || (header.index_size != sizeof(uint16_t)
+        && header.index_size != sizeof(uint32_t))
+    || header.vertex_count > INT32_MAX || header.index_count > INT32_MAX
+    || header.submesh_count > INT32_MAX || header.meshlet_count > INT32_MAX
+    || header.lod_count == 0 || header.lod_count > MaxMeshLodCount
+    || !stream_in_file(header.vertices_offset, sizes.vertices, file.size)
+    || !stream_in_file(header.uvs_offset, sizes.uvs, file.size)
+    || !stream_in_file(header.indices_offset, sizes.indices, file.size)
+    || !stream_in_file(header.submeshes_offset, sizes.submeshes, file.size)
+    || !stream_in_file(header.lods_offset, sizes.lods, file.size)
+    || !stream_in_file(header.meshlets_offset, sizes.meshlets, file.size)
+    || !stream_in_file(
+      header.quantized_positions_offset, sizes.quantized_positions,
+      file.size)
+    || !stream_in_file(
+      header.quantized_uvs_offset, sizes.quantized_uvs, file.size)) {
+    mapped_file_close(&file);
+    return false;
+  }
+
+  *buffers = (mesh_buffers_t){
+    .vertices = (const float*)(file.data + header.vertices_offset),
+    .uvs = (const float*)(file.data + header.uvs_offset),
+    .indices = file.data + header.indices_offset,
+    .submeshes = (const submesh_t*)(file.data + header.submeshes_offset),
+    .lods = (const mesh_lod_t*)(file.data + header.lods_offset),
+    .meshlets = header.meshlet_count != 0
+                ? (const meshlet_t*)(file.data + header.meshlets_offset)
+                : NULL,
+    .vertex_count = (int)header.vertex_count,
+    .index_count = (int)header.index_count,
+    .index_size = (int)header.index_size,
+    .submesh_count = (int)header.submesh_count,
+    .lod_count = (int)header.lod_count,
+    .meshlet_count = (int)header.meshlet_count,
+    .cache_file = file};
+  if (!valid_ranges(buffers)) {
+    mapped_file_close(&file);
+    *buffers = (mesh_buffers_t){0};
+    return false;
+  }
+  if (header.quantized != 0) {
+    quantized_vertices_t* quantized = &buffers->quantized;
+    quantized->positions =
+      (const int16_t*)(file.data + header.quantized_positions_offset);
+    quantized->uvs =
+      (const uint16_t*)(file.data + header.quantized_uvs_offset);
+    memcpy(
+      quantized->position_offset, header.position_offset,
+      sizeof header.position_offset);
+    memcpy(
+      quantized->position_scale, header.position_scale,
+      sizeof header.position_scale);
+    quantized->max_position_error = header.max_position_error;
+    quantized->max_uv_error = header.max_uv_error;
+  }
+  *import_ms = header.import_ms;
+  return true;
+}
+
+static bool write_stream(
+  FILE* file, const void* data, const uint64_t offset, const uint64_t size) {
+  return fseek(file, (long)offset, SEEK_SET) == 0
+      && (size == 0 || fwrite(data, (size_t)size, 1, file) == 1);
+}
+
+bool mesh_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mesh_import_options_t* options, const mesh_buffers_t* buffers,
+  const double import_ms) {
+  mesh_cache_header_t header = {
+    .version = MeshCacheVersion,
+    .source_size = source_stamp->size,
+    .source_mtime = source_stamp->mtime,
+    .import_options = import_options_key(options),
+    .index_size = (uint32_t)buffers->index_size,
+    .import_ms = import_ms,
+    .vertex_count = (uint32_t)buffers->vertex_count,
+    .index_count = (uint32_t)buffers->index_count,
+    .submesh_count = (uint32_t)buffers->submesh_count,
+    .lod_count = (uint32_t)buffers->lod_count,
+    .meshlet_count = (uint32_t)buffers->meshlet_count,
+    .quantized = buffers->quantized.positions != NULL ? 1u : 0u,
+    .max_position_error = buffers->quantized.max_position_error,
+    .max_uv_error = buffers->quantized.max_uv_error};
+  memcpy(header.magic, g_mesh_cache_magic, sizeof header.magic);
+  memcpy(
+    header.position_offset, buffers->quantized.position_offset,
+    sizeof header.position_offset);
+  memcpy(
+    header.position_scale, buffers->quantized.position_scale,
+    sizeof header.position_scale);
+  const mesh_cache_sizes_t sizes = stream_sizes(&header);
+  header.vertices_offset = align_offset(sizeof header);
+  header.uvs_offset = align_offset(header.vertices_offset + sizes.vertices);
+  header.indices_offset = align_offset(header.uvs_offset + sizes.uvs);
+  header.submeshes_offset =
+    align_offset(header.indices_offset + sizes.indices);
+  header.lods_offset = align_offset(header.submeshes_offset + sizes.submeshes);
+  header.meshlets_offset = align_offset(header.lods_offset + sizes.lods);
+  header.quantized_positions_offset =
+    align_offset(header.meshlets_offset + sizes.meshlets);
+  header.quantized_uvs_offset = align_offset(
+    header.quantized_positions_offset + sizes.quantized_positions);
+
+  char temporary_path[1024];
+  FILE* file =
+    cache_file_create(cache_path, temporary_path, sizeof temporary_path);
+  if (file == NULL) {
+    return false;
+  }
+  const bool written =
+    write_stream(file, &header, 0, sizeof header)
+    && write_stream(
+      file, buffers->vertices, header.vertices_offset, sizes.vertices)
+    && write_stream(file, buffers->uvs, header.uvs_offset, sizes.uvs)
+    && write_stream(
+      file, buffers->indices, header.indices_offset, sizes.indices)
+    && write_stream(
+      file, buffers->submeshes, header.submeshes_offset, sizes.submeshes)
+    && write_stream(file, buffers->lods, header.lods_offset, sizes.lods)
+    && write_stream(
+      file, buffers->meshlets, header.meshlets_offset, sizes.meshlets)
+    && write_stream(
+      file, buffers->quantized.positions, header.quantized_positions_offset,
+      sizes.quantized_positions)
+    && write_stream(
+      file, buffers->quantized.uvs, header.quantized_uvs_offset,
+      sizes.quantized_uvs);
+  return cache_file_commit(file, temporary_path, cache_path, written);
+}
@@ -0,0 +1,27 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include "mesh.h"
+
+#include <stdbool.h>
+
+// binary cache of mesh_buffers_t (.smesh), streams are stored ready to be
+// passed straight to sg_make_buffer and are accessed through a memory map
+
+// replaces the extension of source_path with .smesh
+void mesh_cache_path(const char* source_path, char* cache_path, int size);
+
+// fails when the cache is missing, of a different version, was built with
+// different import options or for a different revision of the source (size
+// or modification time differ from source_stamp), the same stamp (taken
+// before the source is read) is passed to save
+bool mesh_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mesh_import_options_t* options, mesh_buffers_t* buffers,
+  double* import_ms);
+bool mesh_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mesh_import_options_t* options, const mesh_buffers_t* buffers,
+  double import_ms);
+
+#endif // MESH_CACHE_H
@@ -0,0 +1,273 @@
+#include "mesh_optimize.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+// tuning values from the reference implementation
+#define ForsythCacheSize 32
+#define ForsythMaxValence 32
+#define ForsythCacheDecayPower 1.5f
+#define ForsythLastTriangleScore 0.75f
+#define ForsythValenceBoostScale 2.0f
+#define ForsythValenceBoostPower 0.5f
+
+typedef struct forsyth_vertex_t {
+  int cache_position; // -1 when not in the cache
+  int remaining_triangle_count;
+  int adjacency_offset;
+  float score;
+} forsyth_vertex_t;
+
+typedef struct forsyth_scores_t {
+  float cache[ForsythCacheSize];
+  float valence[ForsythMaxValence];
+} forsyth_scores_t;
+
+static forsyth_scores_t build_forsyth_scores(void) {
+  forsyth_scores_t scores;
+  for (int p = 0; p < ForsythCacheSize; p++) {
+    // the three vertices of the last triangle share a fixed score so the
+    // order they were added in does not matter
+    scores.cache[p] =
+      p < 3 ? ForsythLastTriangleScore
+            : powf(
+              1.0f - (float)(p - 3) / (float)(ForsythCacheSize - 3),
+              ForsythCacheDecayPower);
+  }
+  scores.valence[0] = 0.0f;
+  for (int v = 1; v < ForsythMaxValence; v++) {
+    // boost vertices with few triangles left to get rid of them early
+    scores.valence[v] =
+      ForsythValenceBoostScale * powf((float)v, -ForsythValenceBoostPower);
+  }
+  return scores;
+}
+
+static float forsyth_vertex_score(
+  const forsyth_scores_t* scores, const forsyth_vertex_t* vertex) {
+  if (vertex->remaining_triangle_count == 0) {
+    return -1.0f;
+  }
+  const int valence = vertex->remaining_triangle_count < ForsythMaxValence
+                      ? vertex->remaining_triangle_count
+                      : ForsythMaxValence - 1;
+  const float cache_score =
+    vertex->cache_position >= 0 ? scores->cache[vertex->cache_position] : 0.0f;
+  return cache_score + scores->valence[valence];
+}
+
+vertex_cache_stats_t analyze_vertex_cache(
+  const uint32_t* indices, const int index_count, const int vertex_count,
+  const int cache_size, arena_t* scratch) {
+  if (index_count < 3 || vertex_count == 0) {
+    return (vertex_cache_stats_t){0};
+  }
+  // a vertex is still cached while fewer than cache_size vertices were
+  // transformed since it was (fifo, hits do not refresh the entry)
+  const arena_mark_t mark = arena_mark(scratch);
+  uint32_t* transformed_at =
+    arena_calloc(scratch, vertex_count, sizeof(uint32_t));
+  uint32_t timestamp = (uint32_t)cache_size + 1;
+  int transformed_count = 0;
+  for (int i = 0; i < index_count; i++) {
+    const uint32_t v = indices[i];
+    if (timestamp - transformed_at[v] > (uint32_t)cache_size) {
+      transformed_at[v] = timestamp++;
+      transformed_count++;
+    }
+  }
+  arena_rewind(scratch, mark);
+  return (vertex_cache_stats_t){
+    .acmr = (float)transformed_count / (float)(index_count / 3),
+    .atvr = (float)transformed_count / (float)vertex_count};
+}
+
+void optimize_vertex_cache(
+  uint32_t* indices, const int index_count, const int vertex_count,
+  arena_t* scratch) {
+  const int triangle_count = index_count / 3;
+  if (triangle_count == 0) {
+    return;
+  }
+
+  const forsyth_scores_t scores = build_forsyth_scores();
+
+  // triangles adjacent to each vertex (triangles still to be emitted are
+  // kept at the front of each vertex's range)
+  const arena_mark_t mark = arena_mark(scratch);
+  forsyth_vertex_t* vertices =
+    arena_calloc(scratch, vertex_count, sizeof(forsyth_vertex_t));
+  for (int i = 0; i < triangle_count * 3; i++) {
+    vertices[indices[i]].remaining_triangle_count++;
+  }
+  int* adjacency =
+    arena_alloc_array(scratch, (size_t)triangle_count * 3, sizeof(int));
+  const arena_mark_t fill_mark = arena_mark(scratch);
+  int* adjacency_fill = arena_alloc_array(scratch, vertex_count, sizeof(int));
+  for (int v = 0, offset = 0; v < vertex_count; v++) {
+    vertices[v].adjacency_offset = offset;
+    vertices[v].cache_position = -1;
+    adjacency_fill[v] = offset;
+    offset += vertices[v].remaining_triangle_count;
+  }
+  for (int i = 0; i < triangle_count * 3; i++) {
+    adjacency[adjacency_fill[indices[i]]++] = i / 3;
+  }
+  arena_rewind(scratch, fill_mark);
+
+  for (int v = 0; v < vertex_count; v++) {
+    vertices[v].score = forsyth_vertex_score(&scores, &vertices[v]);
+  }
+  bool* emitted = arena_calloc(scratch, triangle_count, sizeof(bool));
+  uint32_t* ordered =
+    arena_alloc_array(scratch, (size_t)triangle_count * 3, sizeof(uint32_t));
+
+  int cache[ForsythCacheSize + 3];
+  int cache_count = 0;
+  int best_triangle = -1;
+  int next_unemitted = 0;
+  for (int e = 0; e < triangle_count; e++) {
+    if (best_triangle < 0) {
+      // nothing left next to the cache, restart from the next triangle
+      while (emitted[next_unemitted]) {
+        next_unemitted++;
+      }
+      best_triangle = next_unemitted;
+    }
+    const int t = best_triangle;
+    const uint32_t* triangle = &indices[t * 3];
+    emitted[t] = true;
+    for (int c = 0; c < 3; c++) {
+      ordered[e * 3 + c] = triangle[c];
+      forsyth_vertex_t* vertex = &vertices[triangle[c]];
+      int* triangles = &adjacency[vertex->adjacency_offset];
+      for (int a = 0; a < vertex->remaining_triangle_count; a++) {
+        if (triangles[a] == t) {
+          triangles[a] = triangles[--vertex->remaining_triangle_count];
+          triangles[vertex->remaining_triangle_count] = t;
+          break;
+        }
+      }
+    }
+
+    // lru, the triangle moves to the front and pushes everything else back
+    int next_cache[ForsythCacheSize + 3];
+    int next_cache_count = 0;
+    for (int c = 0; c < 3; c++) {
+      const bool repeated = (c > 0 && triangle[c] == triangle[0])
+                         || (c > 1 && triangle[c] == triangle[1]);
+      if (!repeated) {
+        next_cache[next_cache_count++] = (int)triangle[c];
+      }
+    }
+    for (int c = 0; c < cache_count; c++) {
+      const uint32_t v = (uint32_t)cache[c];
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+        next_cache[next_cache_count++] = (int)v;
+      }
+    }
+
+    // rescore the cached vertices (and any just evicted) then the triangles
+    // still waiting on them, the best of those is emitted next
+    for (int c = 0; c < next_cache_count; c++) {
+      forsyth_vertex_t* vertex = &vertices[next_cache[c]];
+      vertex->cache_position = c < ForsythCacheSize ? c : -1;
+      vertex->score = forsyth_vertex_score(&scores, vertex);
+    }
+    best_triangle = -1;
+    float best_score = -1.0f;
+    for (int c = 0; c < next_cache_count; c++) {
+      const forsyth_vertex_t* vertex = &vertices[next_cache[c]];
+      const int* triangles = &adjacency[vertex->adjacency_offset];
+      for (int a = 0; a < vertex->remaining_triangle_count; a++) {
+        const int n = triangles[a];
+        const float score = vertices[indices[n * 3 + 0]].score
+                          + vertices[indices[n * 3 + 1]].score
+                          + vertices[indices[n * 3 + 2]].score;
+        if (score > best_score) {
+          best_score = score;
+          best_triangle = n;
+        }
+      }
+    }
+
+    cache_count =
+      next_cache_count < ForsythCacheSize ? next_cache_count : ForsythCacheSize;
+    for (int c = 0; c < cache_count; c++) {
+      cache[c] = next_cache[c];
+    }
+  }
+
+  for (int i = 0; i < triangle_count * 3; i++) {
+    indices[i] = ordered[i];
+  }
+
+  arena_rewind(scratch, mark);
+}
+
+int optimize_vertex_fetch_remap(
+  uint32_t* indices, const int index_count, const int vertex_count,
+  int* remap) {
+  for (int v = 0; v < vertex_count; v++) {
+    remap[v] = -1;
+  }
+  int next_vertex = 0;
+  for (int i = 0; i < index_count; i++) {
+    const uint32_t v = indices[i];
+    if (remap[v] < 0) {
+      remap[v] = next_vertex++;
+    }
+    indices[i] = (uint32_t)remap[v];
+  }
+  return next_vertex;
+}
+
+static uint32_t hash_position(uint64_t key) {
+  // murmur3 64-bit finalizer
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdull;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ull;
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+// open addressing table kept at most half full
+static uint32_t position_table_size(const int count) {
+  uint32_t size = 16;
+  while (size < (uint32_t)count * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+
+int* build_position_ids(
+  const float* positions, const int vertex_count, arena_t* scratch) {
+  int* position_ids = arena_alloc_array(scratch, vertex_count, sizeof(int));
+  const uint32_t slot_count = position_table_size(vertex_count);
+  const arena_mark_t mark = arena_mark(scratch);
+  int* slots = arena_alloc_array(scratch, slot_count, sizeof(int));
+  for (uint32_t s = 0; s < slot_count; s++) {
+    slots[s] = -1;
+  }
+  for (int v = 0; v < vertex_count; v++) {
+    const float* position = &positions[v * 3];
+    uint32_t bits[3];
+    memcpy(bits, position, sizeof bits);
+    const uint64_t key = ((uint64_t)bits[0] << 32)
+                       ^ ((uint64_t)bits[1] << 16) ^ (uint64_t)bits[2];
+    uint32_t slot = hash_position(key) & (slot_count - 1);
+    while (slots[slot] != -1
+           && memcmp(&positions[slots[slot] * 3], position, sizeof bits)
+                != 0) {
+      slot = (slot + 1) & (slot_count - 1);
+    }
+    if (slots[slot] == -1) {
+      slots[slot] = v;
+    }
+    position_ids[v] = slots[slot];
+  }
+  arena_rewind(scratch, mark);
+  return position_ids;
+}
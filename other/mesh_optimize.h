@@ -0,0 +1,43 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include "arena.h"
+
+#include <stdint.h>
+
+// cache size used when reporting post-transform vertex cache efficiency
+#define VertexCacheAnalysisSize 16
+
+typedef struct vertex_cache_stats_t {
+  // average cache miss ratio (transformed vertices per triangle, 0.5 - 3.0)
+  float acmr;
+  // average transformed vertex ratio (transformed vertices per vertex, 1.0+)
+  float atvr;
+} vertex_cache_stats_t;
+
+// temporaries of the functions below come from scratch and are released
+// before they return
+
+// simulates a fifo post-transform cache of cache_size entries
+vertex_cache_stats_t analyze_vertex_cache(
+  const uint32_t* indices, int index_count, int vertex_count, int cache_size,
+  arena_t* scratch);
+
+// reorders triangles in place to improve post-transform cache hits
+// (Tom Forsyth, Linear-Speed Vertex Cache Optimisation)
+void optimize_vertex_cache(
+  uint32_t* indices, int index_count, int vertex_count, arena_t* scratch);
+
+// computes remap (old vertex -> new vertex, -1 when unreferenced) so
+// vertices are stored in the order they are first referenced and rewrites
+// indices to match, returns the number of referenced vertices
+int optimize_vertex_fetch_remap(
+  uint32_t* indices, int index_count, int vertex_count, int* remap);
+
+// maps each vertex to the first vertex with a bitwise equal position (so
+// vertices split by uv seams share an id), the result is allocated from
+// scratch
+int* build_position_ids(
+  const float* positions, int vertex_count, arena_t* scratch);
+
+#endif // MESH_OPTIMIZE_H
@@ -0,0 +1,425 @@
+#include "mesh_simplify.h"
+
+#include "mesh_optimize.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// sum of squared distances to planes as a symmetric 4x4 matrix (upper
+// triangle), each plane weighted by the area of its triangle
+typedef struct quadric_t {
+  double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+  double weight; // total area
+} quadric_t;
+
+// collapse of every vertex at one position onto the vertices at another
+typedef struct collapse_t {
+  int from; // position ids
+  int to;
+  double error;
+} collapse_t;
+
+// vertices sharing a position, vertices[offsets[p]..offsets[p + 1]) for
+// position id p
+typedef struct position_vertices_t {
+  int* offsets;
+  int* vertices;
+} position_vertices_t;
+
+// vertex to triangles, triangles[offsets[v]..offsets[v + 1]) for vertex v
+typedef struct vertex_triangles_t {
+  int* offsets;
+  int* triangles;
+} vertex_triangles_t;
+
+static uint32_t hash_key(uint64_t key) {
+  // murmur3 64-bit finalizer
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdull;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ull;
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+static uint32_t table_size(const int count) {
+  uint32_t size = 16;
+  while (size < (uint32_t)count * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+
+static position_vertices_t build_position_vertices(
+  const int* position_ids, const int vertex_count, arena_t* scratch) {
+  position_vertices_t result = {
+    .offsets = arena_calloc(scratch, (size_t)vertex_count + 1, sizeof(int)),
+    .vertices = arena_alloc_array(scratch, vertex_count, sizeof(int))};
+  for (int v = 0; v < vertex_count; v++) {
+    result.offsets[position_ids[v] + 1]++;
+  }
+  for (int p = 0; p < vertex_count; p++) {
+    result.offsets[p + 1] += result.offsets[p];
+  }
+  const arena_mark_t mark = arena_mark(scratch);
+  int* fill = arena_alloc_array(scratch, vertex_count, sizeof(int));
+  memcpy(fill, result.offsets, vertex_count * sizeof(int));
+  for (int v = 0; v < vertex_count; v++) {
+    result.vertices[fill[position_ids[v]]++] = v;
+  }
+  arena_rewind(scratch, mark);
+  return result;
+}
+
+static void build_vertex_triangles(
+  vertex_triangles_t* adjacency, const uint32_t* indices,
+  const int index_count, const int vertex_count, arena_t* scratch) {
+  memset(adjacency->offsets, 0, (vertex_count + 1) * sizeof(int));
+  for (int i = 0; i < index_count; i++) {
+    adjacency->offsets[indices[i] + 1]++;
+  }
+  for (int v = 0; v < vertex_count; v++) {
+    adjacency->offsets[v + 1] += adjacency->offsets[v];
+  }
+  const arena_mark_t mark = arena_mark(scratch);
+  int* fill = arena_alloc_array(scratch, vertex_count, sizeof(int));
+  memcpy(fill, adjacency->offsets, vertex_count * sizeof(int));
+  for (int i = 0; i < index_count; i++) {
+    adjacency->triangles[fill[indices[i]]++] = i / 3;
+  }
+  arena_rewind(scratch, mark);
+}
+
+// positions on an open border (a directed edge without its opposite) are
+// locked so holes and open edges keep their outline
+static bool* find_border_positions(
+  const uint32_t* indices, const int index_count, const int* position_ids,
+  const int vertex_count, arena_t* scratch) {
+  bool* border = arena_calloc(scratch, vertex_count, sizeof(bool));
+  const uint32_t slot_count = table_size(index_count);
+  const arena_mark_t mark = arena_mark(scratch);
+  uint64_t* edges = arena_alloc_array(scratch, slot_count, sizeof(uint64_t));
+  for (uint32_t s = 0; s < slot_count; s++) {
+    edges[s] = UINT64_MAX;
+  }
+  for (int i = 0; i < index_count; i++) {
+    const uint32_t a = (uint32_t)position_ids[indices[i]];
+    const uint32_t b =
+      (uint32_t)position_ids[indices[i % 3 == 2 ? i - 2 : i + 1]];
+    const uint64_t key = ((uint64_t)a << 32) | b;
+    uint32_t slot = hash_key(key) & (slot_count - 1);
+    while (edges[slot] != UINT64_MAX && edges[slot] != key) {
+      slot = (slot + 1) & (slot_count - 1);
+    }
+    edges[slot] = key;
+  }
+  for (uint32_t s = 0; s < slot_count; s++) {
+    if (edges[s] == UINT64_MAX) {
+      continue;
+    }
+    const uint32_t a = (uint32_t)(edges[s] >> 32);
+    const uint32_t b = (uint32_t)edges[s];
+    if (a == b) {
+      continue;
+    }
+    const uint64_t opposite = ((uint64_t)b << 32) | a;
+    uint32_t slot = hash_key(opposite) & (slot_count - 1);
+    while (edges[slot] != UINT64_MAX && edges[slot] != opposite) {
+      slot = (slot + 1) & (slot_count - 1);
+    }
+    if (edges[slot] == UINT64_MAX) {
+      border[a] = true;
+      border[b] = true;
+    }
+  }
+  arena_rewind(scratch, mark);
+  return border;
+}
+
+static void quadric_add(quadric_t* q, const quadric_t* other) {
+  q->a00 += other->a00;
+  q->a01 += other->a01;
+  q->a02 += other->a02;
+  q->a03 += other->a03;
+  q->a11 += other->a11;
+  q->a12 += other->a12;
+  q->a13 += other->a13;
+  q->a22 += other->a22;
+  q->a23 += other->a23;
+  q->a33 += other->a33;
+  q->weight += other->weight;
+}
+
+static quadric_t triangle_quadric(
+  const float* p0, const float* p1, const float* p2) {
+  const double e1[] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+  const double e2[] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+  double n[] = {
+    e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+    e1[0] * e2[1] - e1[1] * e2[0]};
+  const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  if (length == 0.0) {
+    return (quadric_t){0};
+  }
+  n[0] /= length;
+  n[1] /= length;
+  n[2] /= length;
+  const double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+  const double w = length * 0.5;
+  return (quadric_t){
+    .a00 = w * n[0] * n[0],
+    .a01 = w * n[0] * n[1],
+    .a02 = w * n[0] * n[2],
+    .a03 = w * n[0] * d,
+    .a11 = w * n[1] * n[1],
+    .a12 = w * n[1] * n[2],
+    .a13 = w * n[1] * d,
+    .a22 = w * n[2] * n[2],
+    .a23 = w * n[2] * d,
+    .a33 = w * d * d,
+    .weight = w};
+}
+
+// mean squared distance of p to the planes of q
+static double quadric_error(const quadric_t* q, const float* p) {
+  const double x = p[0];
+  const double y = p[1];
+  const double z = p[2];
+  const double error =
+    q->a00 * x * x + q->a11 * y * y + q->a22 * z * z
+    + 2.0 * (q->a01 * x * y + q->a02 * x * z + q->a12 * y * z)
+    + 2.0 * (q->a03 * x + q->a13 * y + q->a23 * z) + q->a33;
+  return q->weight > 0.0 && error > 0.0 ? error / q->weight : 0.0;
+}
+
+static int compare_collapses(const void* lhs, const void* rhs) {
+  const double a = ((const collapse_t*)lhs)->error;
+  const double b = ((const collapse_t*)rhs)->error;
+  return (a > b) - (a < b);
+}
+
+static void triangle_normal(
+  const float* p0, const float* p1, const float* p2, float* normal) {
+  const float e1[] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+  const float e2[] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+  normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+  normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+  normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+typedef struct simplify_state_t {
+  const uint32_t* indices;
+  const float* positions;
+  const int* position_ids;
+  position_vertices_t position_vertices;
+  vertex_triangles_t vertex_triangles;
+  uint32_t* remap;
+} simplify_state_t;
+
+// every vertex at from needs a vertex at to sharing one of its triangles to
+// collapse onto (so seams only collapse along the seam) and no remaining
+// triangle may flip, fills remap for the vertices at from when allowed
+static bool try_collapse(
+  simplify_state_t* state, const int from, const int to) {
+  const position_vertices_t* pv = &state->position_vertices;
+  const vertex_triangles_t* vt = &state->vertex_triangles;
+  for (int i = pv->offsets[from]; i < pv->offsets[from + 1]; i++) {
+    const int v = pv->vertices[i];
+    int target = -1;
+    for (int a = vt->offsets[v]; a < vt->offsets[v + 1] && target < 0; a++) {
+      const uint32_t* triangle = &state->indices[vt->triangles[a] * 3];
+      for (int c = 0; c < 3; c++) {
+        if (state->position_ids[triangle[c]] == to) {
+          target = (int)triangle[c];
+          break;
+        }
+      }
+    }
+    if (target < 0 && vt->offsets[v] != vt->offsets[v + 1]) {
+      return false;
+    }
+
+    const float* moved = &state->positions[to * 3];
+    for (int a = vt->offsets[v]; a < vt->offsets[v + 1]; a++) {
+      const uint32_t* triangle = &state->indices[vt->triangles[a] * 3];
+      const float* corners[3];
+      const float* moved_corners[3];
+      bool removed = false;
+      for (int c = 0; c < 3; c++) {
+        removed |= state->position_ids[triangle[c]] == to;
+        corners[c] = &state->positions[triangle[c] * 3];
+        moved_corners[c] = triangle[c] == (uint32_t)v ? moved : corners[c];
+      }
+      if (removed) {
+        continue;
+      }
+      float normal[3];
+      float moved_normal[3];
+      triangle_normal(corners[0], corners[1], corners[2], normal);
+      triangle_normal(
+        moved_corners[0], moved_corners[1], moved_corners[2], moved_normal);
+      // rejects flips and rotations steep enough to fold the surface
+      const float dot = normal[0] * moved_normal[0]
+                      + normal[1] * moved_normal[1]
+                      + normal[2] * moved_normal[2];
+      const float lengths_squared =
+        (normal[0] * normal[0] + normal[1] * normal[1]
+         + normal[2] * normal[2])
+        * (moved_normal[0] * moved_normal[0]
+           + moved_normal[1] * moved_normal[1]
+           + moved_normal[2] * moved_normal[2]);
+      if (dot <= 0.0f || dot * dot < 0.25f * lengths_squared) {
+        return false;
+      }
+    }
+  }
+  for (int i = pv->offsets[from]; i < pv->offsets[from + 1]; i++) {
+    const int v = pv->vertices[i];
+    for (int a = vt->offsets[v]; a < vt->offsets[v + 1]; a++) {
+      const uint32_t* triangle = &state->indices[vt->triangles[a] * 3];
+      for (int c = 0; c < 3; c++) {
+        if (state->position_ids[triangle[c]] == to) {
+          state->remap[v] = triangle[c];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int simplify_mesh(
+  uint32_t* destination, const uint32_t* indices, const int index_count,
+  const float* positions, const int vertex_count,
+  const int target_index_count, float* error, arena_t* scratch) {
+  *error = 0.0f;
+  memcpy(destination, indices, index_count * sizeof(uint32_t));
+  int count = index_count;
+  if (count <= target_index_count) {
+    return count;
+  }
+
+  const arena_mark_t mark = arena_mark(scratch);
+  int* position_ids = build_position_ids(positions, vertex_count, scratch);
+  bool* locked = find_border_positions(
+    indices, index_count, position_ids, vertex_count, scratch);
+  quadric_t* quadrics = arena_calloc(scratch, vertex_count, sizeof(quadric_t));
+  for (int i = 0; i < index_count; i += 3) {
+    const quadric_t q = triangle_quadric(
+      &positions[indices[i] * 3], &positions[indices[i + 1] * 3],
+      &positions[indices[i + 2] * 3]);
+    for (int c = 0; c < 3; c++) {
+      quadric_add(&quadrics[position_ids[indices[i + c]]], &q);
+    }
+  }
+
+  simplify_state_t state = {
+    .indices = destination,
+    .positions = positions,
+    .position_ids = position_ids,
+    .position_vertices =
+      build_position_vertices(position_ids, vertex_count, scratch),
+    .vertex_triangles =
+      {.offsets =
+         arena_alloc_array(scratch, (size_t)vertex_count + 1, sizeof(int)),
+       .triangles = arena_alloc_array(scratch, index_count, sizeof(int))},
+    .remap = arena_alloc_array(scratch, vertex_count, sizeof(uint32_t))};
+  collapse_t* collapses =
+    arena_alloc_array(scratch, (size_t)index_count * 2, sizeof(collapse_t));
+  bool* touched = arena_alloc_array(scratch, vertex_count, sizeof(bool));
+  double max_error = 0.0;
+
+  // each pass collapses independent edges (no two touching the same
+  // triangles) cheapest first, then rebuilds the index list
+  while (count > target_index_count) {
+    build_vertex_triangles(
+      &state.vertex_triangles, destination, count, vertex_count, scratch);
+
+    int collapse_count = 0;
+    for (int i = 0; i < count; i++) {
+      const int a = position_ids[destination[i]];
+      const int b = position_ids[destination[i % 3 == 2 ? i - 2 : i + 1]];
+      if (a == b) {
+        continue;
+      }
+      for (int d = 0; d < 2; d++) {
+        const int from = d == 0 ? a : b;
+        const int to = d == 0 ? b : a;
+        if (locked[from]) {
+          continue;
+        }
+        quadric_t q = quadrics[from];
+        quadric_add(&q, &quadrics[to]);
+        collapses[collapse_count++] = (collapse_t){
+          .from = from,
+          .to = to,
+          .error = quadric_error(&q, &positions[to * 3])};
+      }
+    }
+    qsort(collapses, collapse_count, sizeof(collapse_t), compare_collapses);
+
+    memset(touched, 0, vertex_count * sizeof(bool));
+    for (int v = 0; v < vertex_count; v++) {
+      state.remap[v] = (uint32_t)v;
+    }
+    const int triangles_to_remove = (count - target_index_count + 2) / 3;
+    int removed_triangles = 0;
+    int collapsed = 0;
+    for (int c = 0;
+         c < collapse_count && removed_triangles < triangles_to_remove; c++) {
+      const collapse_t* collapse = &collapses[c];
+      if (
+        touched[collapse->from] || touched[collapse->to]
+        || !try_collapse(&state, collapse->from, collapse->to)) {
+        continue;
+      }
+      quadric_add(&quadrics[collapse->to], &quadrics[collapse->from]);
+      if (collapse->error > max_error) {
+        max_error = collapse->error;
+      }
+      collapsed++;
+
+      // the neighbourhood changes shape, leave it for the next pass
+      const position_vertices_t* pv = &state.position_vertices;
+      const vertex_triangles_t* vt = &state.vertex_triangles;
+      for (int i = pv->offsets[collapse->from];
+           i < pv->offsets[collapse->from + 1]; i++) {
+        const int v = pv->vertices[i];
+        for (int a = vt->offsets[v]; a < vt->offsets[v + 1]; a++) {
+          const uint32_t* triangle = &destination[vt->triangles[a] * 3];
+          bool removed = false;
+          for (int k = 0; k < 3; k++) {
+            touched[position_ids[triangle[k]]] = true;
+            removed |= position_ids[triangle[k]] == collapse->to;
+          }
+          removed_triangles += removed;
+        }
+      }
+    }
+    if (collapsed == 0) {
+      break;
+    }
+
+    int written = 0;
+    for (int i = 0; i < count; i += 3) {
+      const uint32_t v0 = state.remap[destination[i]];
+      const uint32_t v1 = state.remap[destination[i + 1]];
+      const uint32_t v2 = state.remap[destination[i + 2]];
+      const int p0 = position_ids[v0];
+      const int p1 = position_ids[v1];
+      const int p2 = position_ids[v2];
+      if (p0 == p1 || p1 == p2 || p0 == p2) {
+        continue;
+      }
+      destination[written++] = v0;
+      destination[written++] = v1;
+      destination[written++] = v2;
+    }
+    count = written;
+  }
+
+  arena_rewind(scratch, mark);
+  *error = (float)sqrt(max_error);
+  return count;
+}
@@ -0,0 +1,22 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include "arena.h"
+
+#include <stdint.h>
+
+// collapses edges in order of increasing quadric error (Garland and
+// Heckbert, Surface Simplification Using Quadric Error Metrics) until at most
+// target_index_count indices remain or no edge can be collapsed
+// vertices are never moved or added, so the result indexes the same vertex
+// buffer, vertices sharing a position (uv seams) collapse together and open
+// borders are kept
+// destination must hold index_count indices, returns the number written and
+// the largest collapse error (a distance in position units) in error,
+// temporaries come from scratch and are released before returning
+int simplify_mesh(
+  uint32_t* destination, const uint32_t* indices, int index_count,
+  const float* positions, int vertex_count, int target_index_count,
+  float* error, arena_t* scratch);
+
+#endif // MESH_SIMPLIFY_H
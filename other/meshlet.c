@@ -0,0 +1,317 @@
+#include "meshlet.h"
+
+#include "array.h"
+#include "mesh_optimize.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// meshlet being grown, local_indices maps a vertex to its slot in vertices
+// (-1 when not part of the meshlet)
+typedef struct meshlet_builder_t {
+  int* local_indices;
+  int vertices[MaxMeshletVertexCount];
+  int vertex_count;
+  int triangles[MaxMeshletTriangleCount];
+  int triangle_count;
+  float centroid_sum[3];
+} meshlet_builder_t;
+
+static void triangle_centroid(
+  const uint32_t* triangle, const float* positions, float centroid[3]) {
+  for (int a = 0; a < 3; a++) {
+    centroid[a] = (positions[triangle[0] * 3 + a]
+                   + positions[triangle[1] * 3 + a]
+                   + positions[triangle[2] * 3 + a])
+                * (1.0f / 3.0f);
+  }
+}
+
+static int new_vertex_count(
+  const meshlet_builder_t* builder, const uint32_t* triangle) {
+  int count = 0;
+  for (int c = 0; c < 3; c++) {
+    count += builder->local_indices[triangle[c]] == -1
+          && (c < 1 || triangle[c] != triangle[0])
+          && (c < 2 || triangle[c] != triangle[1]);
+  }
+  return count;
+}
+
+static void add_triangle(
+  meshlet_builder_t* builder, const uint32_t* indices, const int t,
+  const float* centroids) {
+  const uint32_t* triangle = &indices[t * 3];
+  for (int c = 0; c < 3; c++) {
+    if (builder->local_indices[triangle[c]] == -1) {
+      builder->local_indices[triangle[c]] = builder->vertex_count;
+      builder->vertices[builder->vertex_count++] = (int)triangle[c];
+    }
+  }
+  for (int a = 0; a < 3; a++) {
+    builder->centroid_sum[a] += centroids[t * 3 + a];
+  }
+  builder->triangles[builder->triangle_count++] = t;
+}
+
+// sphere around the center of the vertex bounds, and the normal cone of the
+// triangles (the cone can not cull when their normals spread 90 degrees or
+// more from the average)
+static meshlet_t meshlet_bounds(
+  const meshlet_builder_t* builder, const uint32_t* indices,
+  const float* positions) {
+  float min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  for (int v = 0; v < builder->vertex_count; v++) {
+    const float* position = &positions[builder->vertices[v] * 3];
+    for (int a = 0; a < 3; a++) {
+      min[a] = fminf(min[a], position[a]);
+      max[a] = fmaxf(max[a], position[a]);
+    }
+  }
+  const as_point3f center = {
+    (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f,
+    (min[2] + max[2]) * 0.5f};
+  float radius_squared = 0.0f;
+  for (int v = 0; v < builder->vertex_count; v++) {
+    const float* position = &positions[builder->vertices[v] * 3];
+    const as_vec3f offset = as_point3f_sub_point3f(
+      (as_point3f){position[0], position[1], position[2]}, center);
+    radius_squared =
+      fmaxf(radius_squared, as_vec3f_dot_vec3f(offset, offset));
+  }
+
+  // unit normals (front faces are clockwise seen from the front, so the
+  // cross product of the first two edges points out of the front face)
+  float normals[MaxMeshletTriangleCount][3];
+  int normal_count = 0;
+  float axis[3] = {0};
+  for (int t = 0; t < builder->triangle_count; t++) {
+    const uint32_t* triangle = &indices[builder->triangles[t] * 3];
+    const float* p0 = &positions[triangle[0] * 3];
+    const float* p1 = &positions[triangle[1] * 3];
+    const float* p2 = &positions[triangle[2] * 3];
+    const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    float* normal = normals[normal_count];
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    const float length = sqrtf(
+      normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length <= FLT_MIN) {
+      continue; // degenerate, never rasterized
+    }
+    for (int a = 0; a < 3; a++) {
+      normal[a] /= length;
+      axis[a] += normal[a];
+    }
+    normal_count++;
+  }
+  const float axis_length =
+    sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+  float min_dot = 1.0f;
+  if (axis_length > FLT_MIN) {
+    for (int a = 0; a < 3; a++) {
+      axis[a] /= axis_length;
+    }
+    for (int n = 0; n < normal_count; n++) {
+      const float dot = normals[n][0] * axis[0] + normals[n][1] * axis[1]
+                      + normals[n][2] * axis[2];
+      min_dot = fminf(min_dot, dot);
+    }
+  } else {
+    min_dot = normal_count > 0 ? -1.0f : 1.0f;
+  }
+
+  return (meshlet_t){
+    .center = center,
+    .radius = sqrtf(radius_squared),
+    .cone_axis = (as_vec3f){axis[0], axis[1], axis[2]},
+    .cone_cutoff = min_dot <= 0.0f ? 1.0f : sqrtf(1.0f - min_dot * min_dot)};
+}
+
+meshlet_t* build_meshlets(
+  meshlet_t* meshlets, uint32_t* indices, const int index_count,
+  const float* positions, const int vertex_count, const int index_offset,
+  arena_t* scratch) {
+  const int triangle_count = index_count / 3;
+  if (triangle_count <= 0) {
+    return meshlets;
+  }
+
+  // triangles adjacent to each position (vertices split by a uv seam are
+  // still neighbors)
+  const arena_mark_t mark = arena_mark(scratch);
+  int* position_ids = build_position_ids(positions, vertex_count, scratch);
+  int* adjacency_offsets =
+    arena_calloc(scratch, (size_t)vertex_count + 1, sizeof(int));
+  for (int i = 0; i < triangle_count * 3; i++) {
+    adjacency_offsets[position_ids[indices[i]] + 1]++;
+  }
+  for (int v = 0; v < vertex_count; v++) {
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+  }
+  int* adjacency =
+    arena_alloc_array(scratch, (size_t)triangle_count * 3, sizeof(int));
+  const arena_mark_t fill_mark = arena_mark(scratch);
+  int* adjacency_fill = arena_alloc_array(scratch, vertex_count, sizeof(int));
+  memcpy(adjacency_fill, adjacency_offsets, vertex_count * sizeof(int));
+  for (int i = 0; i < triangle_count * 3; i++) {
+    adjacency[adjacency_fill[position_ids[indices[i]]]++] = i / 3;
+  }
+  arena_rewind(scratch, fill_mark);
+  float* centroids =
+    arena_alloc_array(scratch, (size_t)triangle_count * 3, sizeof(float));
+  for (int t = 0; t < triangle_count; t++) {
+    triangle_centroid(&indices[t * 3], positions, &centroids[t * 3]);
+  }
+
+  meshlet_builder_t builder = {
+    .local_indices = arena_alloc_array(scratch, vertex_count, sizeof(int))};
+  for (int v = 0; v < vertex_count; v++) {
+    builder.local_indices[v] = -1;
+  }
+  bool* emitted = arena_calloc(scratch, triangle_count, sizeof(bool));
+  uint32_t* ordered =
+    arena_alloc_array(scratch, (size_t)triangle_count * 3, sizeof(uint32_t));
+
+  int ordered_count = 0;
+  int next_unemitted = 0;
+  while (ordered_count < triangle_count) {
+    int best_triangle = -1;
+    if (builder.triangle_count == 0) {
+      // seed the next meshlet from the input order (which is already
+      // optimized for locality when optimize_vertex_cache was used)
+      while (emitted[next_unemitted]) {
+        next_unemitted++;
+      }
+      best_triangle = next_unemitted;
+    } else if (builder.triangle_count < MaxMeshletTriangleCount) {
+      // neighbor adding the fewest vertices, then closest to the centroid
+      const float centroid_scale = 1.0f / (float)builder.triangle_count;
+      const float centroid[3] = {
+        builder.centroid_sum[0] * centroid_scale,
+        builder.centroid_sum[1] * centroid_scale,
+        builder.centroid_sum[2] * centroid_scale};
+      int best_new_vertex_count = 4;
+      float best_distance = FLT_MAX;
+      for (int v = 0; v < builder.vertex_count; v++) {
+        const int position = position_ids[builder.vertices[v]];
+        for (int a = adjacency_offsets[position];
+             a < adjacency_offsets[position + 1]; a++) {
+          const int t = adjacency[a];
+          if (emitted[t]) {
+            continue;
+          }
+          const uint32_t* triangle = &indices[t * 3];
+          const int new_vertices = new_vertex_count(&builder, triangle);
+          if (
+            builder.vertex_count + new_vertices > MaxMeshletVertexCount
+            || new_vertices > best_new_vertex_count) {
+            continue;
+          }
+          const float offset[3] = {
+            centroids[t * 3 + 0] - centroid[0],
+            centroids[t * 3 + 1] - centroid[1],
+            centroids[t * 3 + 2] - centroid[2]};
+          const float distance = offset[0] * offset[0]
+                               + offset[1] * offset[1]
+                               + offset[2] * offset[2];
+          if (
+            new_vertices < best_new_vertex_count
+            || distance < best_distance) {
+            best_new_vertex_count = new_vertices;
+            best_distance = distance;
+            best_triangle = t;
+          }
+        }
+      }
+    }
+
+    if (best_triangle >= 0) {
+      emitted[best_triangle] = true;
+      add_triangle(&builder, indices, best_triangle, centroids);
+      continue;
+    }
+
+    // full or no neighbor fits, emit the meshlet and start the next one
+    meshlet_t meshlet = meshlet_bounds(&builder, indices, positions);
+    meshlet.index_offset = index_offset + ordered_count * 3;
+    meshlet.index_count = builder.triangle_count * 3;
+    array_push(meshlets, meshlet);
+    for (int t = 0; t < builder.triangle_count; t++) {
+      memcpy(
+        &ordered[ordered_count++ * 3], &indices[builder.triangles[t] * 3],
+        3 * sizeof(uint32_t));
+    }
+    for (int v = 0; v < builder.vertex_count; v++) {
+      builder.local_indices[builder.vertices[v]] = -1;
+    }
+    builder.vertex_count = 0;
+    builder.triangle_count = 0;
+    memset(builder.centroid_sum, 0, sizeof builder.centroid_sum);
+  }
+
+  memcpy(indices, ordered, (size_t)triangle_count * 3 * sizeof(uint32_t));
+
+  arena_rewind(scratch, mark);
+  return meshlets;
+}
+
+meshlet_culling_t make_meshlet_culling(
+  const frustum_planes_t* planes, const as_mat34f* model,
+  const as_mat34f* view) {
+  const as_mat34f model_view = as_mat34f_mul_mat34f_v(*view, *model);
+  const float* m = model_view.elem;
+  float axis_scales[3];
+  for (int a = 0; a < 3; a++) {
+    axis_scales[a] =
+      sqrtf(m[a] * m[a] + m[4 + a] * m[4 + a] + m[8 + a] * m[8 + a]);
+  }
+  const float min_scale =
+    fminf(axis_scales[0], fminf(axis_scales[1], axis_scales[2]));
+  const float max_scale =
+    fmaxf(axis_scales[0], fmaxf(axis_scales[1], axis_scales[2]));
+  // a mirrored transform swaps the faces the gpu culls
+  const float determinant = m[0] * (m[5] * m[10] - m[6] * m[9])
+                          - m[1] * (m[4] * m[10] - m[6] * m[8])
+                          + m[2] * (m[4] * m[9] - m[5] * m[8]);
+  const as_mat34f view_model = as_mat34f_inverse_v(model_view);
+  return (meshlet_culling_t){
+    .planes = *planes,
+    .model_view = model_view,
+    .radius_scale = max_scale,
+    .camera_position = (as_point3f){
+      view_model.elem[3], view_model.elem[7], view_model.elem[11]},
+    .cull_backfaces =
+      determinant > 0.0f && max_scale - min_scale <= max_scale * 1e-3f};
+}
+
+meshlet_cull_e cull_meshlet(
+  const meshlet_t* meshlet, const meshlet_culling_t* culling) {
+  const as_point3f view_center =
+    as_mat34f_mul_point3f(&culling->model_view, meshlet->center);
+  const float radius = meshlet->radius * culling->radius_scale;
+  for (int p = 0; p < FrustumPlaneCount; p++) {
+    const as_plane* plane = &culling->planes.planes[p];
+    const float distance = as_vec3f_dot_vec3f(
+      plane->normal, as_point3f_sub_point3f(view_center, plane->point));
+    if (distance < -radius) {
+      return meshlet_cull_frustum;
+    }
+  }
+  // the camera is behind the plane of every triangle when the direction to
+  // the sphere is inside the cone (widened by the sphere)
+  if (culling->cull_backfaces) {
+    const as_vec3f to_center =
+      as_point3f_sub_point3f(meshlet->center, culling->camera_position);
+    if (
+      as_vec3f_dot_vec3f(to_center, meshlet->cone_axis)
+      >= meshlet->cone_cutoff * as_vec3f_length(to_center) + meshlet->radius) {
+      return meshlet_cull_backface;
+    }
+  }
+  return meshlet_cull_visible;
+}
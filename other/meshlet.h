@@ -0,0 +1,63 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include "arena.h"
+#include "frustum.h"
+
+#include <as-ops.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// limits of a meshlet (the vertex count matches common mesh shader limits,
+// 124 triangles keeps the index data of a meshlet under 1536 bytes)
+#define MaxMeshletVertexCount 64
+#define MaxMeshletTriangleCount 124
+
+// cluster of neighboring triangles stored as a contiguous range of the index
+// buffer, bounds are in model space
+typedef struct meshlet_t {
+  int index_offset;
+  int index_count;
+  as_point3f center; // bounding sphere
+  float radius;
+  // average front facing normal and the sine of the largest angle between
+  // it and a triangle normal (1 when the triangles face too many ways)
+  as_vec3f cone_axis;
+  float cone_cutoff;
+} meshlet_t;
+
+typedef enum meshlet_cull_e {
+  meshlet_cull_visible,
+  meshlet_cull_frustum, // outside the view frustum
+  meshlet_cull_backface // every triangle faces away from the camera
+} meshlet_cull_e;
+
+// what a meshlet is tested against, see make_meshlet_culling
+typedef struct meshlet_culling_t {
+  frustum_planes_t planes; // view space (see build_frustum_planes)
+  as_mat34f model_view;
+  float radius_scale; // largest axis scale of model_view
+  as_point3f camera_position; // model space
+  // normals are only preserved by rotations and uniform scales
+  bool cull_backfaces;
+} meshlet_culling_t;
+
+// reorders the triangles (indices relative to positions) into meshlets of
+// at most MaxMeshletVertexCount vertices and MaxMeshletTriangleCount
+// triangles, grown greedily from the neighbors adding the fewest vertices
+// (triangles sharing a position, so uv seams do not end a meshlet), and
+// appends them to meshlets (an array.h array) with index_offset added to
+// each meshlet range, temporaries come from scratch and are released before
+// returning
+meshlet_t* build_meshlets(
+  meshlet_t* meshlets, uint32_t* indices, int index_count,
+  const float* positions, int vertex_count, int index_offset,
+  arena_t* scratch);
+
+meshlet_culling_t make_meshlet_culling(
+  const frustum_planes_t* planes, const as_mat34f* model,
+  const as_mat34f* view);
+meshlet_cull_e cull_meshlet(
+  const meshlet_t* meshlet, const meshlet_culling_t* culling);
+
+#endif // MESHLET_H
@@ -0,0 +1,105 @@
+#include "mip_cache.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// bump whenever the layout or contents of the cache change
+#define MipCacheVersion 1
+#define MipCacheAlignment 16
+
+static const char g_mip_cache_magic[4] = {'S', 'M', 'I', 'P'};
+
+typedef struct mip_cache_header_t {
+  char magic[4];
+  uint32_t version;
+  // revision of the source the cache was built from
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint32_t width;
+  uint32_t height;
+  uint32_t level_count;
+  uint32_t padding;
+  uint64_t pixel_count;
+  uint64_t pixels_offset;
+} mip_cache_header_t;
+
+static uint64_t align_offset(const uint64_t offset) {
+  const uint64_t mask = MipCacheAlignment - 1;
+  return (offset + mask) & ~mask;
+}
+
+void mip_cache_path(
+  const char* source_path, char* cache_path, const int size) {
+  const char* extension = strrchr(source_path, '.');
+  const char* separator = strrchr(source_path, '/');
+  const int stem_length =
+    extension != NULL && (separator == NULL || extension > separator)
+      ? (int)(extension - source_path)
+      : (int)strlen(source_path);
+  snprintf(cache_path, size, "%.*s.smip", stem_length, source_path);
+}
+
+bool mip_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp, const int width,
+  const int height, mip_chain_t* chain) {
+  mapped_file_t file;
+  if (!mapped_file_open(&file, cache_path)) {
+    return false;
+  }
+
+  mip_cache_header_t header;
+  if (file.size < sizeof header) {
+    mapped_file_close(&file);
+    return false;
+  }
+  memcpy(&header, file.data, sizeof header);
+
+  const mip_chain_t layout = mip_chain_layout(width, height);
+  if (
+    memcmp(header.magic, g_mip_cache_magic, sizeof header.magic) != 0
+    || header.version != MipCacheVersion
+    || header.source_size != source_stamp->size
+    || header.source_mtime != source_stamp->mtime
+    || header.width != (uint32_t)width || header.height != (uint32_t)height
+    || header.level_count != (uint32_t)layout.level_count
+    || header.pixel_count != layout.pixel_count
+    || header.pixels_offset + header.pixel_count * sizeof(uint32_t)
+         > file.size) {
+    mapped_file_close(&file);
+    return false;
+  }
+
+  *chain = layout;
+  chain->pixels = (const uint32_t*)(file.data + header.pixels_offset);
+  chain->cache_file = file;
+  return true;
+}
+
+bool mip_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mip_chain_t* chain) {
+  mip_cache_header_t header = {
+    .version = MipCacheVersion,
+    .source_size = source_stamp->size,
+    .source_mtime = source_stamp->mtime,
+    .width = (uint32_t)chain->widths[0],
+    .height = (uint32_t)chain->heights[0],
+    .level_count = (uint32_t)chain->level_count,
+    .pixel_count = chain->pixel_count,
+    .pixels_offset = align_offset(sizeof header)};
+  memcpy(header.magic, g_mip_cache_magic, sizeof header.magic);
+
+  char temporary_path[1024];
+  FILE* file =
+    cache_file_create(cache_path, temporary_path, sizeof temporary_path);
+  if (file == NULL) {
+    return false;
+  }
+  const size_t pixels_size = chain->pixel_count * sizeof(uint32_t);
+  const bool written =
+    fwrite(&header, sizeof header, 1, file) == 1
+    && fseek(file, (long)header.pixels_offset, SEEK_SET) == 0
+    && (pixels_size == 0 || fwrite(chain->pixels, pixels_size, 1, file) == 1);
+  return cache_file_commit(file, temporary_path, cache_path, written);
+}
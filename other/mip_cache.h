@@ -0,0 +1,24 @@
+#ifndef MIP_CACHE_H
+#define MIP_CACHE_H
+
+#include "mipmap.h"
+
+#include <stdbool.h>
+
+// binary cache of the mip chain of a texture (.smip) stored next to it,
+// levels are accessed through a memory map and uploaded as is
+
+// replaces the extension of source_path with .smip
+void mip_cache_path(const char* source_path, char* cache_path, int size);
+
+// fails when the cache is missing, of a different version or was built for
+// a different revision (size or modification time, see source_stamp) or
+// size of the source
+bool mip_cache_load(
+  const char* cache_path, const file_stamp_t* source_stamp, int width,
+  int height, mip_chain_t* chain);
+bool mip_cache_save(
+  const char* cache_path, const file_stamp_t* source_stamp,
+  const mip_chain_t* chain);
+
+#endif // MIP_CACHE_H
@@ -0,0 +1,303 @@
+#include "mipmap.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+// linear values are encoded through a table this large (the steps must be
+// finer than those of dark srgb values, where srgb is most precise)
+#define LinearToSrgbTableSize 16384
+
+typedef struct srgb_tables_t {
+  float to_linear[256];
+  uint8_t to_srgb[LinearToSrgbTableSize];
+} srgb_tables_t;
+
+static float srgb_to_linear(const float value) {
+  return value <= 0.04045f ? value / 12.92f
+                           : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(const float value) {
+  return value <= 0.0031308f ? value * 12.92f
+                             : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static void build_srgb_tables(srgb_tables_t* tables) {
+  for (int i = 0; i < 256; i++) {
+    tables->to_linear[i] = srgb_to_linear((float)i / 255.0f);
+  }
+  for (int i = 0; i < LinearToSrgbTableSize; i++) {
+    const float linear = (float)i / (float)(LinearToSrgbTableSize - 1);
+    tables->to_srgb[i] = (uint8_t)lrintf(linear_to_srgb(linear) * 255.0f);
+  }
+}
+
+int mip_level_count(int width, int height) {
+  int level_count = 1;
+  while ((width > 1 || height > 1) && level_count < MaxMipLevelCount) {
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+    level_count++;
+  }
+  return level_count;
+}
+
+mip_chain_t mip_chain_layout(const int width, const int height) {
+  mip_chain_t chain = {.level_count = mip_level_count(width, height)};
+  chain.widths[0] = width;
+  chain.heights[0] = height;
+  for (int l = 1; l < chain.level_count; l++) {
+    chain.widths[l] = chain.widths[l - 1] > 1 ? chain.widths[l - 1] / 2 : 1;
+    chain.heights[l] =
+      chain.heights[l - 1] > 1 ? chain.heights[l - 1] / 2 : 1;
+    chain.offsets[l] = chain.pixel_count;
+    chain.pixel_count += (size_t)chain.widths[l] * chain.heights[l];
+  }
+  return chain;
+}
+
+// each destination pixel averages a 2x2 block of the source, the last row
+// and column are repeated when the source size is odd
+typedef void (*downsample_srgb8_fn)(
+  const uint8_t* source, int source_width, int source_height,
+  float* destination, int width, int height, const srgb_tables_t* tables);
+typedef void (*downsample_linear_fn)(
+  const float* source, int source_width, int source_height,
+  float* destination, int width, int height);
+typedef void (*encode_srgb8_fn)(
+  const float* source, uint8_t* destination, size_t pixel_count,
+  const srgb_tables_t* tables);
+
+static void downsample_srgb8_scalar(
+  const uint8_t* source, const int source_width, const int source_height,
+  float* destination, const int width, const int height,
+  const srgb_tables_t* tables) {
+  for (int y = 0; y < height; y++) {
+    const int y0 = 2 * y;
+    const int y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_height - 1;
+    for (int x = 0; x < width; x++) {
+      const int x0 = 2 * x;
+      const int x1 = 2 * x + 1 < source_width ? 2 * x + 1 : source_width - 1;
+      const uint8_t* block[4] = {
+        source + ((size_t)y0 * source_width + x0) * 4,
+        source + ((size_t)y0 * source_width + x1) * 4,
+        source + ((size_t)y1 * source_width + x0) * 4,
+        source + ((size_t)y1 * source_width + x1) * 4};
+      float* pixel = destination + ((size_t)y * width + x) * 4;
+      for (int c = 0; c < 3; c++) {
+        pixel[c] = 0.25f
+                 * (tables->to_linear[block[0][c]]
+                    + tables->to_linear[block[1][c]]
+                    + tables->to_linear[block[2][c]]
+                    + tables->to_linear[block[3][c]]);
+      }
+      pixel[3] = (0.25f / 255.0f)
+               * (float)(block[0][3] + block[1][3] + block[2][3] + block[3][3]);
+    }
+  }
+}
+
+static void downsample_linear_scalar(
+  const float* source, const int source_width, const int source_height,
+  float* destination, const int width, const int height) {
+  for (int y = 0; y < height; y++) {
+    const int y0 = 2 * y;
+    const int y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_height - 1;
+    for (int x = 0; x < width; x++) {
+      const int x0 = 2 * x;
+      const int x1 = 2 * x + 1 < source_width ? 2 * x + 1 : source_width - 1;
+      const float* block[4] = {
+        source + ((size_t)y0 * source_width + x0) * 4,
+        source + ((size_t)y0 * source_width + x1) * 4,
+        source + ((size_t)y1 * source_width + x0) * 4,
+        source + ((size_t)y1 * source_width + x1) * 4};
+      float* pixel = destination + ((size_t)y * width + x) * 4;
+      for (int c = 0; c < 4; c++) {
+        pixel[c] =
+          0.25f * (block[0][c] + block[1][c] + block[2][c] + block[3][c]);
+      }
+    }
+  }
+}
+
+static void encode_srgb8_scalar(
+  const float* source, uint8_t* destination, const size_t pixel_count,
+  const srgb_tables_t* tables) {
+  for (size_t p = 0; p < pixel_count; p++) {
+    for (int c = 0; c < 4; c++) {
+      float value = source[p * 4 + c];
+      value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+      destination[p * 4 + c] =
+        c < 3 ? tables->to_srgb[(int)lrintf(
+                  value * (float)(LinearToSrgbTableSize - 1))]
+              : (uint8_t)lrintf(value * 255.0f);
+    }
+  }
+}
+
+#ifdef MIPMAP_SSE2
+// one pixel (four channels) per register
+
+static __m128 decode_srgb8(const uint8_t* pixel, const srgb_tables_t* tables) {
+  return _mm_setr_ps(
+    tables->to_linear[pixel[0]], tables->to_linear[pixel[1]],
+    tables->to_linear[pixel[2]], (float)pixel[3] * (1.0f / 255.0f));
+}
+
+static void downsample_srgb8_sse2(
+  const uint8_t* source, const int source_width, const int source_height,
+  float* destination, const int width, const int height,
+  const srgb_tables_t* tables) {
+  const __m128 quarter = _mm_set1_ps(0.25f);
+  for (int y = 0; y < height; y++) {
+    const int y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_height - 1;
+    const uint8_t* row0 = source + (size_t)(2 * y) * source_width * 4;
+    const uint8_t* row1 = source + (size_t)y1 * source_width * 4;
+    for (int x = 0; x < width; x++) {
+      const int x0 = 2 * x * 4;
+      const int x1 =
+        (2 * x + 1 < source_width ? 2 * x + 1 : source_width - 1) * 4;
+      const __m128 sum = _mm_add_ps(
+        _mm_add_ps(
+          decode_srgb8(row0 + x0, tables), decode_srgb8(row0 + x1, tables)),
+        _mm_add_ps(
+          decode_srgb8(row1 + x0, tables), decode_srgb8(row1 + x1, tables)));
+      _mm_storeu_ps(
+        destination + ((size_t)y * width + x) * 4, _mm_mul_ps(sum, quarter));
+    }
+  }
+}
+
+static void downsample_linear_sse2(
+  const float* source, const int source_width, const int source_height,
+  float* destination, const int width, const int height) {
+  const __m128 quarter = _mm_set1_ps(0.25f);
+  for (int y = 0; y < height; y++) {
+    const int y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_height - 1;
+    const float* row0 = source + (size_t)(2 * y) * source_width * 4;
+    const float* row1 = source + (size_t)y1 * source_width * 4;
+    float* destination_row = destination + (size_t)y * width * 4;
+    // pairs of source pixels are adjacent, except for the last column of
+    // an odd width source
+    const int paired_width = source_width % 2 == 0 ? width : width - 1;
+    int x = 0;
+    for (; x < paired_width; x++) {
+      const __m128 sum = _mm_add_ps(
+        _mm_add_ps(
+          _mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row0 + x * 8 + 4)),
+        _mm_add_ps(
+          _mm_loadu_ps(row1 + x * 8), _mm_loadu_ps(row1 + x * 8 + 4)));
+      _mm_storeu_ps(destination_row + x * 4, _mm_mul_ps(sum, quarter));
+    }
+    for (; x < width; x++) {
+      const int x0 = 2 * x * 4;
+      const int x1 =
+        (2 * x + 1 < source_width ? 2 * x + 1 : source_width - 1) * 4;
+      const __m128 sum = _mm_add_ps(
+        _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1)),
+        _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1)));
+      _mm_storeu_ps(destination_row + x * 4, _mm_mul_ps(sum, quarter));
+    }
+  }
+}
+
+static void encode_srgb8_sse2(
+  const float* source, uint8_t* destination, const size_t pixel_count,
+  const srgb_tables_t* tables) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  // color channels index the table, alpha is stored directly
+  const float table_max = (float)(LinearToSrgbTableSize - 1);
+  const __m128 scale = _mm_setr_ps(table_max, table_max, table_max, 255.0f);
+  for (size_t p = 0; p < pixel_count; p++) {
+    const __m128 value =
+      _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + p * 4), zero), one);
+    // rounds to nearest
+    int32_t indices[4];
+    _mm_storeu_si128(
+      (__m128i*)indices, _mm_cvtps_epi32(_mm_mul_ps(value, scale)));
+    uint8_t* pixel = destination + p * 4;
+    pixel[0] = tables->to_srgb[indices[0]];
+    pixel[1] = tables->to_srgb[indices[1]];
+    pixel[2] = tables->to_srgb[indices[2]];
+    pixel[3] = (uint8_t)indices[3];
+  }
+}
+#endif
+
+static mip_chain_t build_mip_chain_with(
+  const uint32_t* pixels, const int width, const int height,
+  const bool simd) {
+  downsample_srgb8_fn downsample_srgb8 = downsample_srgb8_scalar;
+  downsample_linear_fn downsample_linear = downsample_linear_scalar;
+  encode_srgb8_fn encode_srgb8 = encode_srgb8_scalar;
+#ifdef MIPMAP_SSE2
+  if (simd) {
+    downsample_srgb8 = downsample_srgb8_sse2;
+    downsample_linear = downsample_linear_sse2;
+    encode_srgb8 = encode_srgb8_sse2;
+  }
+#else
+  (void)simd;
+#endif
+
+  mip_chain_t chain = mip_chain_layout(width, height);
+  if (chain.level_count < 2) {
+    return chain;
+  }
+  chain.pixels = malloc(chain.pixel_count * sizeof(uint32_t));
+  srgb_tables_t* tables = malloc(sizeof(srgb_tables_t));
+  build_srgb_tables(tables);
+  // linear rgba of the previous and current level (level 1 is the largest)
+  const size_t linear_size =
+    (size_t)chain.widths[1] * chain.heights[1] * 4 * sizeof(float);
+  float* previous = malloc(linear_size);
+  float* current = malloc(linear_size);
+  uint32_t* levels = (uint32_t*)chain.pixels;
+  for (int l = 1; l < chain.level_count; l++) {
+    if (l == 1) {
+      downsample_srgb8(
+        (const uint8_t*)pixels, width, height, current, chain.widths[l],
+        chain.heights[l], tables);
+    } else {
+      downsample_linear(
+        previous, chain.widths[l - 1], chain.heights[l - 1], current,
+        chain.widths[l], chain.heights[l]);
+    }
+    encode_srgb8(
+      current, (uint8_t*)(levels + chain.offsets[l]),
+      (size_t)chain.widths[l] * chain.heights[l], tables);
+    float* swap = previous;
+    previous = current;
+    current = swap;
+  }
+  free(current);
+  free(previous);
+  free(tables);
+  return chain;
+}
+
+mip_chain_t build_mip_chain(
+  const uint32_t* pixels, const int width, const int height) {
+  return build_mip_chain_with(pixels, width, height, true);
+}
+
+mip_chain_t build_mip_chain_scalar(
+  const uint32_t* pixels, const int width, const int height) {
+  return build_mip_chain_with(pixels, width, height, false);
+}
+
+void free_mip_chain(mip_chain_t* chain) {
+  if (chain->cache_file.data != NULL) {
+    mapped_file_close(&chain->cache_file);
+  } else {
+    free((void*)chain->pixels);
+  }
+  *chain = (mip_chain_t){0};
+}
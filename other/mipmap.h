@@ -0,0 +1,42 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include "mapped_file.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// matches the most mip levels sokol_gfx accepts (SG_MAX_MIPMAPS)
+#define MaxMipLevelCount 16
+
+// the levels below an rgba8 texture, each half the size of the one above
+// (rounded down, at least one pixel) down to 1x1
+typedef struct mip_chain_t {
+  // level 0 is the texture itself and is not stored here
+  int level_count;
+  int widths[MaxMipLevelCount];
+  int heights[MaxMipLevelCount];
+  // levels 1 and up packed one after another, offsets are in pixels
+  const uint32_t* pixels;
+  size_t offsets[MaxMipLevelCount];
+  size_t pixel_count;
+  // set when pixels point into a cache file (see mip_cache.h)
+  mapped_file_t cache_file;
+} mip_chain_t;
+
+// levels of a full chain including level 0 (capped at MaxMipLevelCount)
+int mip_level_count(int width, int height);
+// sizes and offsets of the levels, without pixels
+mip_chain_t mip_chain_layout(int width, int height);
+// 2x2 box filter in linear space, color is decoded from srgb before
+// averaging and encoded again after, alpha is averaged as is, vectorized
+// with sse2 where available
+mip_chain_t build_mip_chain(const uint32_t* pixels, int width, int height);
+// the same filter one channel at a time (reference for the vectorized
+// version)
+mip_chain_t build_mip_chain_scalar(
+  const uint32_t* pixels, int width, int height);
+void free_mip_chain(mip_chain_t* chain);
+
+#endif // MIPMAP_H
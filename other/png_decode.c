@@ -0,0 +1,928 @@
+#include "png_decode.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PNG_DECODE_SSE2
+#include <emmintrin.h>
+#endif
+
+// codes up to this long are decoded with a single table lookup
+#define HuffmanFastBits 10
+#define HuffmanFastMask ((1 << HuffmanFastBits) - 1)
+// inflated between two rounds of unfiltering (the rows are still in cache)
+#define InflateFlushBytes (64 * 1024)
+// the furthest back a match reaches
+#define InflateWindowBytes (32 * 1024)
+// the longest match and the bytes a word copy writes past it
+#define InflateMatchBytes (258 + 8)
+// largest width or height accepted
+#define MaxPngSize (1 << 16)
+
+static const uint8_t g_png_signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+typedef enum png_color_type_e {
+  png_color_type_gray = 0,
+  png_color_type_rgb = 2,
+  png_color_type_palette = 3,
+  png_color_type_gray_alpha = 4,
+  png_color_type_rgba = 6
+} png_color_type_e;
+
+static uint32_t read_u32_be(const uint8_t* bytes) {
+  return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16)
+       | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+// reads the zlib stream from the data of consecutive idat chunks, bits are
+// consumed from the low end of bits
+typedef struct bit_reader_t {
+  const uint8_t* next;
+  const uint8_t* chunk_end; // of the data of the current idat
+  const uint8_t* file_end;
+  uint64_t bits;
+  int bit_count;
+  int padding_count; // zero bytes added past the last idat
+} bit_reader_t;
+
+// moves to the data of the next chunk when it's an idat
+static bool next_idat(bit_reader_t* reader) {
+  // skips the crc of the current chunk
+  const uint8_t* chunk = reader->chunk_end + 4;
+  if (reader->file_end - chunk < 8 || memcmp(chunk + 4, "IDAT", 4) != 0) {
+    return false;
+  }
+  const uint32_t length = read_u32_be(chunk);
+  if (length > (size_t)(reader->file_end - chunk - 8)) {
+    return false;
+  }
+  reader->next = chunk + 8;
+  reader->chunk_end = reader->next + length;
+  return true;
+}
+
+// buffers at least 56 bits (at most 63), past the end of the stream zeros
+// are added (see padding_count)
+static void refill(bit_reader_t* reader) {
+  if (reader->chunk_end - reader->next >= 8) {
+    // bits above bit_count may be set, they always hold the bytes that
+    // follow so or-ing them again is harmless
+    uint64_t word;
+    memcpy(&word, reader->next, sizeof word);
+    reader->bits |= word << reader->bit_count;
+    reader->next += (63 - reader->bit_count) >> 3;
+    reader->bit_count |= 56;
+    return;
+  }
+  while (reader->bit_count < 56) {
+    if (reader->next == reader->chunk_end) {
+      if (reader->padding_count > 0 || !next_idat(reader)) {
+        reader->padding_count++;
+        reader->bit_count += 8;
+        continue;
+      }
+      continue;
+    }
+    reader->bits |= (uint64_t)*reader->next++ << reader->bit_count;
+    reader->bit_count += 8;
+  }
+}
+
+// call refill first, at most 32 bits
+static uint32_t read_bits(bit_reader_t* reader, const int count) {
+  const uint32_t value = (uint32_t)(reader->bits & ((1ull << count) - 1));
+  reader->bits >>= count;
+  reader->bit_count -= count;
+  return value;
+}
+
+// canonical huffman code, codes are stored with their first bit lowest
+typedef struct huffman_t {
+  // length << 9 | symbol for codes up to HuffmanFastBits, 0 otherwise
+  uint16_t fast[1 << HuffmanFastBits];
+  // first code past each length, left aligned to 16 bits
+  uint32_t max_codes[17];
+  uint16_t first_codes[16];
+  uint16_t first_symbols[16];
+  uint16_t symbols[288]; // in code order
+} huffman_t;
+
+static int reverse_bits(int value, const int count) {
+  int reversed = 0;
+  for (int b = 0; b < count; b++) {
+    reversed = (reversed << 1) | (value & 1);
+    value >>= 1;
+  }
+  return reversed;
+}
+
+static bool build_huffman(
+  huffman_t* huffman, const uint8_t* lengths, const int count) {
+  int length_counts[16] = {0};
+  for (int s = 0; s < count; s++) {
+    length_counts[lengths[s]]++;
+  }
+  length_counts[0] = 0;
+  memset(huffman->fast, 0, sizeof huffman->fast);
+  int next_codes[16];
+  int code = 0;
+  int symbol = 0;
+  for (int length = 1; length < 16; length++) {
+    next_codes[length] = code;
+    huffman->first_codes[length] = (uint16_t)code;
+    huffman->first_symbols[length] = (uint16_t)symbol;
+    code += length_counts[length];
+    // more codes than the length can hold
+    if (code > (1 << length)) {
+      return false;
+    }
+    huffman->max_codes[length] = (uint32_t)code << (16 - length);
+    code <<= 1;
+    symbol += length_counts[length];
+  }
+  huffman->max_codes[16] = 0x10000;
+  for (int s = 0; s < count; s++) {
+    const int length = lengths[s];
+    if (length == 0) {
+      continue;
+    }
+    const int symbol_code = next_codes[length]++;
+    huffman->symbols
+      [huffman->first_symbols[length] + symbol_code
+       - huffman->first_codes[length]] = (uint16_t)s;
+    if (length <= HuffmanFastBits) {
+      for (int f = reverse_bits(symbol_code, length);
+           f < (1 << HuffmanFastBits); f += 1 << length) {
+        huffman->fast[f] = (uint16_t)((length << 9) | s);
+      }
+    }
+  }
+  return true;
+}
+
+// call refill first, returns -1 for an unused code
+static int decode_symbol(bit_reader_t* reader, const huffman_t* huffman) {
+  const int entry = huffman->fast[reader->bits & HuffmanFastMask];
+  if (entry != 0) {
+    read_bits(reader, entry >> 9);
+    return entry & 511;
+  }
+  const uint32_t code =
+    (uint32_t)reverse_bits((int)(reader->bits & 0xffff), 16);
+  int length = HuffmanFastBits + 1;
+  while (code >= huffman->max_codes[length]) {
+    length++;
+  }
+  if (length == 16) {
+    return -1;
+  }
+  read_bits(reader, length);
+  return huffman->symbols
+    [(code >> (16 - length)) - huffman->first_codes[length]
+     + huffman->first_symbols[length]];
+}
+
+static const uint16_t g_length_bases[29] = {
+  3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t g_length_extra_bits[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t g_distance_bases[30] = {
+  1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+  33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t g_distance_extra_bits[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+  6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t g_code_length_order[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static bool read_dynamic_huffman(
+  bit_reader_t* reader, huffman_t* literals, huffman_t* distances) {
+  refill(reader);
+  const int literal_count = (int)read_bits(reader, 5) + 257;
+  const int distance_count = (int)read_bits(reader, 5) + 1;
+  const int code_length_count = (int)read_bits(reader, 4) + 4;
+  if (literal_count > 286 || distance_count > 30) {
+    return false;
+  }
+  uint8_t code_length_lengths[19] = {0};
+  for (int c = 0; c < code_length_count; c++) {
+    refill(reader);
+    code_length_lengths[g_code_length_order[c]] =
+      (uint8_t)read_bits(reader, 3);
+  }
+  huffman_t code_lengths;
+  if (!build_huffman(&code_lengths, code_length_lengths, 19)) {
+    return false;
+  }
+
+  // literal and distance lengths form a single sequence
+  uint8_t lengths[286 + 30];
+  const int length_count = literal_count + distance_count;
+  for (int l = 0; l < length_count;) {
+    refill(reader);
+    const int symbol = decode_symbol(reader, &code_lengths);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[l++] = (uint8_t)symbol;
+      continue;
+    }
+    int repeat;
+    uint8_t value = 0;
+    if (symbol == 16) {
+      if (l == 0) {
+        return false;
+      }
+      repeat = 3 + (int)read_bits(reader, 2);
+      value = lengths[l - 1];
+    } else if (symbol == 17) {
+      repeat = 3 + (int)read_bits(reader, 3);
+    } else {
+      repeat = 11 + (int)read_bits(reader, 7);
+    }
+    if (l + repeat > length_count) {
+      return false;
+    }
+    memset(&lengths[l], value, (size_t)repeat);
+    l += repeat;
+  }
+  return build_huffman(literals, lengths, literal_count)
+      && build_huffman(distances, lengths + literal_count, distance_count);
+}
+
+static void build_fixed_huffman(huffman_t* literals, huffman_t* distances) {
+  uint8_t lengths[288];
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+  build_huffman(literals, lengths, 288);
+  memset(lengths, 5, 30);
+  build_huffman(distances, lengths, 30);
+}
+
+// called as output is produced with the window (window[0] is byte offset of
+// the output) and the number of bytes inflated so far, returns the offset of
+// the first byte that is still needed
+typedef size_t (*inflate_flush_fn)(
+  void* user_data, const uint8_t* window, size_t offset, size_t inflated);
+
+// the last InflateWindowBytes of output (the furthest a match reaches back)
+// and whatever the flush callback still needs
+typedef struct inflate_window_t {
+  uint8_t* bytes;
+  size_t capacity;
+  size_t offset; // in the output of bytes[0]
+  size_t length; // of bytes in use
+  size_t size; // of the whole output
+  inflate_flush_fn flush;
+  void* user_data;
+} inflate_window_t;
+
+// the capacity leaves room for this much (and the history) after sliding
+static size_t inflate_window_capacity(const size_t needed) {
+  const size_t kept = needed > InflateWindowBytes ? needed : InflateWindowBytes;
+  return kept + InflateFlushBytes + InflateMatchBytes;
+}
+
+// flushes then drops the bytes that are no longer needed
+static void slide_window(inflate_window_t* window) {
+  const size_t position = window->offset + window->length;
+  const size_t needed =
+    window->flush(window->user_data, window->bytes, window->offset, position);
+  size_t keep_from =
+    position > InflateWindowBytes ? position - InflateWindowBytes : 0;
+  keep_from = needed < keep_from ? needed : keep_from;
+  const size_t dropped = keep_from - window->offset;
+  memmove(window->bytes, window->bytes + dropped, window->length - dropped);
+  window->offset = keep_from;
+  window->length -= dropped;
+}
+
+static bool copy_stored_block(
+  bit_reader_t* reader, inflate_window_t* window) {
+  // the length starts at the next byte
+  read_bits(reader, reader->bit_count & 7);
+  refill(reader);
+  const uint32_t length = read_bits(reader, 16);
+  const uint32_t inverted_length = read_bits(reader, 16);
+  if (
+    (length ^ 0xffff) != inverted_length
+    || window->size - window->offset - window->length < length) {
+    return false;
+  }
+  uint32_t remaining = length;
+  // bytes already buffered first
+  while (remaining > 0 && reader->bit_count >= 8) {
+    if (window->length == window->capacity) {
+      slide_window(window);
+    }
+    window->bytes[window->length++] = (uint8_t)read_bits(reader, 8);
+    remaining--;
+  }
+  if (reader->padding_count * 8 > reader->bit_count) {
+    return false;
+  }
+  if (reader->bit_count == 0) {
+    // the buffer may hold bytes past bit_count that are copied below
+    reader->bits = 0;
+    while (remaining > 0) {
+      if (reader->next == reader->chunk_end && !next_idat(reader)) {
+        return false;
+      }
+      if (window->length == window->capacity) {
+        slide_window(window);
+      }
+      size_t available = (size_t)(reader->chunk_end - reader->next);
+      available = available < remaining ? available : remaining;
+      const size_t space = window->capacity - window->length;
+      available = available < space ? available : space;
+      memcpy(window->bytes + window->length, reader->next, available);
+      reader->next += available;
+      window->length += available;
+      remaining -= (uint32_t)available;
+    }
+  }
+  return true;
+}
+
+// inflates exactly window->size bytes through the window, the flush callback
+// sees every byte before it is dropped
+static bool inflate_idat(bit_reader_t* reader, inflate_window_t* window) {
+  refill(reader);
+  const uint32_t method = read_bits(reader, 8);
+  const uint32_t flags = read_bits(reader, 8);
+  // deflate, no preset dictionary
+  if (
+    (method & 15) != 8 || (method >> 4) > 7 || (flags & 32) != 0
+    || ((method << 8) | flags) % 31 != 0) {
+    return false;
+  }
+
+  huffman_t literals;
+  huffman_t distances;
+  const size_t size = window->size;
+  const size_t slide_at = window->capacity - InflateMatchBytes;
+  bool final_block = false;
+  while (!final_block) {
+    refill(reader);
+    if (reader->padding_count > 8) {
+      return false;
+    }
+    final_block = read_bits(reader, 1) != 0;
+    const uint32_t type = read_bits(reader, 2);
+    if (type == 0) {
+      if (!copy_stored_block(reader, window)) {
+        return false;
+      }
+      continue;
+    }
+    if (type == 1) {
+      build_fixed_huffman(&literals, &distances);
+    } else if (
+      type != 2 || !read_dynamic_huffman(reader, &literals, &distances)) {
+      return false;
+    }
+    for (;;) {
+      // room for the longest match and the word copy past it
+      if (window->length > slide_at) {
+        slide_window(window);
+      }
+      // enough bits for a length and a distance with their extra bits
+      refill(reader);
+      int symbol = decode_symbol(reader, &literals);
+      const size_t position = window->offset + window->length;
+      if (symbol < 256) {
+        if (symbol < 0 || position == size) {
+          return false;
+        }
+        window->bytes[window->length++] = (uint8_t)symbol;
+        continue;
+      }
+      if (symbol == 256) {
+        break;
+      }
+      symbol -= 257;
+      if (symbol >= 29) {
+        return false;
+      }
+      const size_t length = g_length_bases[symbol]
+                          + read_bits(reader, g_length_extra_bits[symbol]);
+      symbol = decode_symbol(reader, &distances);
+      if (symbol < 0 || symbol >= 30) {
+        return false;
+      }
+      const size_t distance =
+        g_distance_bases[symbol]
+        + read_bits(reader, g_distance_extra_bits[symbol]);
+      if (distance > window->length || size - position < length) {
+        return false;
+      }
+      uint8_t* destination = window->bytes + window->length;
+      const uint8_t* source = destination - distance;
+      if (distance >= 8) {
+        // whole words, the few bytes written past length are overwritten
+        // by what follows
+        for (size_t c = 0; c < length; c += 8) {
+          memcpy(destination + c, source + c, 8);
+        }
+      } else if (distance == 1) {
+        memset(destination, *source, length);
+      } else {
+        for (size_t c = 0; c < length; c++) {
+          destination[c] = source[c];
+        }
+      }
+      window->length += length;
+    }
+  }
+  // reading into the padding means the stream was cut short
+  if (
+    window->offset + window->length != size
+    || reader->padding_count * 8 > reader->bit_count) {
+    return false;
+  }
+  window->flush(window->user_data, window->bytes, window->offset, size);
+  return true;
+}
+
+// reconstructs a row from its filtered bytes and the row above
+typedef void (*unfilter_fn)(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  size_t stride, int bpp);
+
+static void unfilter_none(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  (void)previous;
+  (void)bpp;
+  memcpy(row, filtered, stride);
+}
+
+static void unfilter_sub_scalar(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  (void)previous;
+  for (size_t i = 0; i < (size_t)bpp; i++) {
+    row[i] = filtered[i];
+  }
+  for (size_t i = (size_t)bpp; i < stride; i++) {
+    row[i] = (uint8_t)(filtered[i] + row[i - bpp]);
+  }
+}
+
+static void unfilter_up_scalar(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  (void)bpp;
+  for (size_t i = 0; i < stride; i++) {
+    row[i] = (uint8_t)(filtered[i] + previous[i]);
+  }
+}
+
+static void unfilter_average_scalar(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  for (size_t i = 0; i < (size_t)bpp; i++) {
+    row[i] = (uint8_t)(filtered[i] + (previous[i] >> 1));
+  }
+  for (size_t i = (size_t)bpp; i < stride; i++) {
+    row[i] = (uint8_t)(filtered[i] + ((row[i - bpp] + previous[i]) >> 1));
+  }
+}
+
+static uint8_t paeth_predictor(const int a, const int b, const int c) {
+  const int pa = abs(b - c);
+  const int pb = abs(a - c);
+  const int pc = abs(a + b - 2 * c);
+  if (pa <= pb && pa <= pc) {
+    return (uint8_t)a;
+  }
+  return (uint8_t)(pb <= pc ? b : c);
+}
+
+static void unfilter_paeth_scalar(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  for (size_t i = 0; i < (size_t)bpp; i++) {
+    row[i] = (uint8_t)(filtered[i] + previous[i]);
+  }
+  for (size_t i = (size_t)bpp; i < stride; i++) {
+    row[i] = (uint8_t)(
+      filtered[i]
+      + paeth_predictor(row[i - bpp], previous[i], previous[i - bpp]));
+  }
+}
+
+#ifdef PNG_DECODE_SSE2
+
+// rgb and rgba pixels are filtered in the low lanes of a register, each
+// pixel depends on the one to its left so only up and sub (rgba, using a
+// prefix sum) work on several pixels at once
+
+// rgb pixels move as 4 bytes except the last of a row, the extra byte
+// read belongs to the next pixel and the one written is overwritten by it
+static inline __m128i load_pixel(
+  const uint8_t* bytes, const int bpp, const bool last) {
+  uint32_t pixel = 0;
+  if (bpp == 4 || !last) {
+    memcpy(&pixel, bytes, 4);
+  } else {
+    memcpy(&pixel, bytes, 3);
+  }
+  return _mm_cvtsi32_si128((int)pixel);
+}
+
+static inline void store_pixel(
+  uint8_t* bytes, const __m128i pixel, const int bpp, const bool last) {
+  const uint32_t value = (uint32_t)_mm_cvtsi128_si32(pixel);
+  if (bpp == 4 || !last) {
+    memcpy(bytes, &value, 4);
+  } else {
+    memcpy(bytes, &value, 3);
+  }
+}
+
+static void unfilter_up_sse2(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  size_t i = 0;
+  for (; i + 16 <= stride; i += 16) {
+    const __m128i sum = _mm_add_epi8(
+      _mm_loadu_si128((const __m128i*)(filtered + i)),
+      _mm_loadu_si128((const __m128i*)(previous + i)));
+    _mm_storeu_si128((__m128i*)(row + i), sum);
+  }
+  unfilter_up_scalar(row + i, filtered + i, previous + i, stride - i, bpp);
+}
+
+static void unfilter_sub_sse2(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  if (bpp != 3 && bpp != 4) {
+    unfilter_sub_scalar(row, filtered, previous, stride, bpp);
+    return;
+  }
+  __m128i left = _mm_setzero_si128(); // in every lane
+  size_t i = 0;
+  if (bpp == 4) {
+    for (; i + 16 <= stride; i += 16) {
+      __m128i pixels = _mm_loadu_si128((const __m128i*)(filtered + i));
+      pixels = _mm_add_epi8(pixels, _mm_slli_si128(pixels, 4));
+      pixels = _mm_add_epi8(pixels, _mm_slli_si128(pixels, 8));
+      pixels = _mm_add_epi8(pixels, left);
+      _mm_storeu_si128((__m128i*)(row + i), pixels);
+      left = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+  }
+  for (; i < stride; i += (size_t)bpp) {
+    const bool last = i + (size_t)bpp == stride;
+    left = _mm_add_epi8(load_pixel(filtered + i, bpp, last), left);
+    store_pixel(row + i, left, bpp, last);
+  }
+}
+
+// bpp is a constant at each call so pixels load and store in one go
+static inline void unfilter_average_pixels(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  const __m128i ones = _mm_set1_epi8(1);
+  __m128i left = _mm_setzero_si128();
+  for (size_t i = 0; i < stride; i += (size_t)bpp) {
+    const bool last = i + (size_t)bpp == stride;
+    const __m128i up = load_pixel(previous + i, bpp, last);
+    // avg_epu8 rounds up, the average must round down
+    const __m128i average = _mm_sub_epi8(
+      _mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), ones));
+    left = _mm_add_epi8(load_pixel(filtered + i, bpp, last), average);
+    store_pixel(row + i, left, bpp, last);
+  }
+}
+
+static void unfilter_average_sse2(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  if (bpp == 4) {
+    unfilter_average_pixels(row, filtered, previous, stride, 4);
+  } else if (bpp == 3) {
+    unfilter_average_pixels(row, filtered, previous, stride, 3);
+  } else {
+    unfilter_average_scalar(row, filtered, previous, stride, bpp);
+  }
+}
+
+static __m128i abs_epi16(const __m128i value) {
+  return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+}
+
+static __m128i select_si128(
+  const __m128i mask, const __m128i lhs, const __m128i rhs) {
+  return _mm_or_si128(_mm_and_si128(mask, lhs), _mm_andnot_si128(mask, rhs));
+}
+
+static inline void unfilter_paeth_pixels(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  // left (a), up (b) and up left (c) as 16-bit lanes
+  const __m128i zero = _mm_setzero_si128();
+  __m128i a = zero;
+  __m128i c = zero;
+  for (size_t i = 0; i < stride; i += (size_t)bpp) {
+    const bool last = i + (size_t)bpp == stride;
+    const __m128i b =
+      _mm_unpacklo_epi8(load_pixel(previous + i, bpp, last), zero);
+    __m128i pa = _mm_sub_epi16(b, c);
+    __m128i pb = _mm_sub_epi16(a, c);
+    __m128i pc = _mm_add_epi16(pa, pb);
+    pa = abs_epi16(pa);
+    pb = abs_epi16(pb);
+    pc = abs_epi16(pc);
+    const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    const __m128i nearest = select_si128(
+      _mm_cmpeq_epi16(pa, smallest), a,
+      select_si128(_mm_cmpeq_epi16(pb, smallest), b, c));
+    const __m128i pixel = _mm_add_epi8(
+      load_pixel(filtered + i, bpp, last), _mm_packus_epi16(nearest, nearest));
+    store_pixel(row + i, pixel, bpp, last);
+    a = _mm_unpacklo_epi8(pixel, zero);
+    c = b;
+  }
+}
+
+static void unfilter_paeth_sse2(
+  uint8_t* row, const uint8_t* filtered, const uint8_t* previous,
+  const size_t stride, const int bpp) {
+  if (bpp == 4) {
+    unfilter_paeth_pixels(row, filtered, previous, stride, 4);
+  } else if (bpp == 3) {
+    unfilter_paeth_pixels(row, filtered, previous, stride, 3);
+  } else {
+    unfilter_paeth_scalar(row, filtered, previous, stride, bpp);
+  }
+}
+
+#endif // PNG_DECODE_SSE2
+
+// filter types 0 to 4
+typedef struct unfilters_t {
+  unfilter_fn filters[5];
+} unfilters_t;
+
+static const unfilters_t g_scalar_unfilters = {
+  {unfilter_none, unfilter_sub_scalar, unfilter_up_scalar,
+   unfilter_average_scalar, unfilter_paeth_scalar}};
+#ifdef PNG_DECODE_SSE2
+static const unfilters_t g_sse2_unfilters = {
+  {unfilter_none, unfilter_sub_sse2, unfilter_up_sse2, unfilter_average_sse2,
+   unfilter_paeth_sse2}};
+#endif
+
+// rows are inflated (each after its filter type) into the window of
+// inflate_idat and unfiltered from there
+typedef struct png_rows_t {
+  uint32_t* pixels;
+  // unfiltered rows (not expanded to rgba8) and zeros above the first
+  uint8_t* previous;
+  uint8_t* current;
+  const uint8_t* zeros;
+  const uint32_t* palette;
+  const unfilters_t* unfilters;
+  png_color_type_e color_type;
+  int width;
+  int height;
+  int bpp;
+  size_t stride;
+  int row; // next to unfilter
+  bool failed; // unknown filter type
+} png_rows_t;
+
+static void expand_row(
+  const png_rows_t* rows, const uint8_t* row, uint32_t* pixels) {
+  const uint32_t opaque = 0xff000000u;
+  int x = 0;
+  switch (rows->color_type) {
+    case png_color_type_gray:
+      for (; x < rows->width; x++) {
+        pixels[x] = opaque | row[x] * 0x010101u;
+      }
+      break;
+    case png_color_type_gray_alpha:
+      for (; x < rows->width; x++) {
+        const uint8_t* gray_alpha = row + x * 2;
+        pixels[x] = ((uint32_t)gray_alpha[1] << 24) | gray_alpha[0] * 0x010101u;
+      }
+      break;
+    case png_color_type_palette:
+      for (; x < rows->width; x++) {
+        pixels[x] = rows->palette[row[x]];
+      }
+      break;
+    case png_color_type_rgb:
+      // four pixels from three words
+      for (; x + 4 <= rows->width; x += 4) {
+        uint32_t words[3];
+        memcpy(words, row + x * 3, sizeof words);
+        pixels[x] = opaque | words[0];
+        pixels[x + 1] = opaque | (words[0] >> 24) | (words[1] << 8);
+        pixels[x + 2] = opaque | (words[1] >> 16) | (words[2] << 16);
+        pixels[x + 3] = opaque | (words[2] >> 8);
+      }
+      for (; x < rows->width; x++) {
+        const uint8_t* rgb = row + x * 3;
+        pixels[x] = opaque | rgb[0] | ((uint32_t)rgb[1] << 8)
+                  | ((uint32_t)rgb[2] << 16);
+      }
+      break;
+    case png_color_type_rgba:
+      break; // unfiltered in place
+  }
+}
+
+// unfilters the rows inflated so far, returns the offset of the next row
+static size_t unfilter_rows(
+  void* user_data, const uint8_t* window, const size_t offset,
+  const size_t inflated) {
+  png_rows_t* rows = user_data;
+  const size_t filtered_stride = rows->stride + 1;
+  while (rows->row < rows->height && !rows->failed
+         && (size_t)(rows->row + 1) * filtered_stride <= inflated) {
+    const uint8_t* filtered =
+      window + ((size_t)rows->row * filtered_stride - offset);
+    if (filtered[0] > 4) {
+      rows->failed = true;
+      break;
+    }
+    uint32_t* pixels = rows->pixels + (size_t)rows->row * rows->width;
+    if (rows->color_type == png_color_type_rgba) {
+      const uint8_t* previous =
+        rows->row > 0 ? (const uint8_t*)(pixels - rows->width) : rows->zeros;
+      rows->unfilters->filters[filtered[0]](
+        (uint8_t*)pixels, filtered + 1, previous, rows->stride, rows->bpp);
+    } else {
+      const uint8_t* previous = rows->row > 0 ? rows->previous : rows->zeros;
+      rows->unfilters->filters[filtered[0]](
+        rows->current, filtered + 1, previous, rows->stride, rows->bpp);
+      expand_row(rows, rows->current, pixels);
+      uint8_t* swap = rows->previous;
+      rows->previous = rows->current;
+      rows->current = swap;
+    }
+    rows->row++;
+  }
+  // nothing more is needed when the decode fails
+  return rows->failed ? inflated : (size_t)rows->row * filtered_stride;
+}
+
+static int channel_count(const png_color_type_e color_type) {
+  switch (color_type) {
+    case png_color_type_gray:
+    case png_color_type_palette:
+      return 1;
+    case png_color_type_gray_alpha:
+      return 2;
+    case png_color_type_rgb:
+      return 3;
+    case png_color_type_rgba:
+      return 4;
+  }
+  return 0;
+}
+
+static uint32_t* decode(
+  const uint8_t* data, const size_t size, int* width, int* height,
+  const unfilters_t* unfilters) {
+  const uint8_t* end = data + size;
+  // the signature and the header (always first)
+  if (
+    size < 8 + 8 + 13 + 4 || memcmp(data, g_png_signature, 8) != 0
+    || read_u32_be(data + 8) != 13 || memcmp(data + 12, "IHDR", 4) != 0) {
+    return NULL;
+  }
+  const uint8_t* header = data + 16;
+  const uint32_t image_width = read_u32_be(header);
+  const uint32_t image_height = read_u32_be(header + 4);
+  const png_color_type_e color_type = (png_color_type_e)header[9];
+  const int bpp = channel_count(color_type);
+  // 8 bits per channel, deflate, adaptive filtering, not interlaced
+  if (
+    image_width == 0 || image_width > MaxPngSize || image_height == 0
+    || image_height > MaxPngSize || header[8] != 8 || bpp == 0
+    || header[10] != 0 || header[11] != 0 || header[12] != 0) {
+    return NULL;
+  }
+
+  // palette entries past the ones defined are opaque black
+  uint32_t palette[256];
+  for (int p = 0; p < 256; p++) {
+    palette[p] = 0xff000000u;
+  }
+  bool has_palette = false;
+  const uint8_t* chunk = header + 13 + 4;
+  bit_reader_t reader = {.file_end = end};
+  for (;;) {
+    if (end - chunk < 12) {
+      return NULL;
+    }
+    const uint32_t length = read_u32_be(chunk);
+    const uint8_t* chunk_data = chunk + 8;
+    if (length > (size_t)(end - chunk_data) - 4) {
+      return NULL;
+    }
+    if (memcmp(chunk + 4, "IDAT", 4) == 0) {
+      reader.next = chunk_data;
+      reader.chunk_end = chunk_data + length;
+      break;
+    }
+    if (memcmp(chunk + 4, "PLTE", 4) == 0) {
+      if (length % 3 != 0 || length > 256 * 3) {
+        return NULL;
+      }
+      for (uint32_t p = 0; p < length / 3; p++) {
+        const uint8_t* rgb = chunk_data + p * 3;
+        palette[p] = 0xff000000u | rgb[0] | ((uint32_t)rgb[1] << 8)
+                   | ((uint32_t)rgb[2] << 16);
+      }
+      has_palette = true;
+    } else if (memcmp(chunk + 4, "tRNS", 4) == 0) {
+      // color keys of gray and rgb images are not supported
+      if (color_type != png_color_type_palette || length > 256) {
+        return NULL;
+      }
+      for (uint32_t p = 0; p < length; p++) {
+        palette[p] = (palette[p] & 0xffffff) | ((uint32_t)chunk_data[p] << 24);
+      }
+    } else if (memcmp(chunk + 4, "IEND", 4) == 0) {
+      return NULL;
+    }
+    chunk = chunk_data + length + 4;
+  }
+  if (color_type == png_color_type_palette && !has_palette) {
+    return NULL;
+  }
+
+  const size_t stride = (size_t)image_width * bpp;
+  // the pixels and the inflated size must fit in a size_t
+  if (image_height > SIZE_MAX / ((size_t)image_width * 4 + 1)) {
+    return NULL;
+  }
+  const size_t pixel_count = (size_t)image_width * image_height;
+  // the window keeps at least a whole row
+  const size_t window_capacity = inflate_window_capacity(stride + 1);
+  uint8_t* window_bytes = malloc(window_capacity);
+  uint8_t* row_buffers = calloc(3, stride);
+  uint32_t* pixels = malloc(pixel_count * sizeof(uint32_t));
+  if (window_bytes == NULL || row_buffers == NULL || pixels == NULL) {
+    free(window_bytes);
+    free(row_buffers);
+    free(pixels);
+    return NULL;
+  }
+  png_rows_t rows = {
+    .pixels = pixels,
+    .previous = row_buffers,
+    .current = row_buffers + stride,
+    .zeros = row_buffers + stride * 2,
+    .palette = palette,
+    .unfilters = unfilters,
+    .color_type = color_type,
+    .width = (int)image_width,
+    .height = (int)image_height,
+    .bpp = bpp,
+    .stride = stride};
+  inflate_window_t window = {
+    .bytes = window_bytes,
+    .capacity = window_capacity,
+    .size = (stride + 1) * image_height,
+    .flush = unfilter_rows,
+    .user_data = &rows};
+  const bool inflated = inflate_idat(&reader, &window);
+  free(window_bytes);
+  free(row_buffers);
+  if (!inflated || rows.failed || rows.row != rows.height) {
+    free(pixels);
+    return NULL;
+  }
+  *width = rows.width;
+  *height = rows.height;
+  return rows.pixels;
+}
+
+uint32_t* png_decode(
+  const uint8_t* data, const size_t size, int* width, int* height) {
+#ifdef PNG_DECODE_SSE2
+  return decode(data, size, width, height, &g_sse2_unfilters);
+#else
+  return decode(data, size, width, height, &g_scalar_unfilters);
+#endif
+}
+
+uint32_t* png_decode_scalar(
+  const uint8_t* data, const size_t size, int* width, int* height) {
+  return decode(data, size, width, height, &g_scalar_unfilters);
+}
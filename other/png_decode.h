@@ -0,0 +1,23 @@
+#ifndef PNG_DECODE_H
+#define PNG_DECODE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// decodes 8-bit, non-interlaced png images (gray, gray and alpha, rgb, rgba
+// or palette) to rgba8, the image data is inflated straight from the idat
+// chunks of data (they are not joined first) into a window of the last 32kb
+// (and at least a row), rows are unfiltered and expanded from the window as
+// soon as they are inflated, while they are still in cache (unfiltering is
+// vectorized with sse2 where available)
+// returns the pixels (free them with free) or NULL when the file is broken
+// or uses another format (see upng)
+uint32_t* png_decode(
+  const uint8_t* data, size_t size, int* width, int* height);
+// the same decode unfiltering one byte at a time (reference for the
+// vectorized version)
+uint32_t* png_decode_scalar(
+  const uint8_t* data, size_t size, int* width, int* height);
+
+#endif // PNG_DECODE_H
@@ -0,0 +1,63 @@
+#include "quantize.h"
+
+#include <math.h>
+#include <string.h>
+
+uint16_t half_from_float(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof bits);
+  const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+  const uint32_t magnitude = bits & 0x7fffffff;
+  if (magnitude > 0x7f800000) {
+    return sign | 0x7e00; // nan
+  }
+  if (magnitude >= 0x47800000) {
+    return sign | 0x7c00; // too large (or infinite)
+  }
+  if (magnitude < 0x33000000) {
+    return sign; // rounds to zero
+  }
+  if (magnitude < 0x38800000) {
+    // subnormal half, shift the mantissa (with its implicit bit) into place
+    const uint32_t exponent = magnitude >> 23;
+    const uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+    const uint32_t shift = 126 - exponent;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    uint32_t half = mantissa >> shift;
+    half += remainder > halfway || (remainder == halfway && (half & 1));
+    return sign | (uint16_t)half;
+  }
+  // rebias the exponent, rounding may carry into it (up to infinity)
+  uint32_t half = (magnitude - 0x38000000) >> 13;
+  const uint32_t remainder = magnitude & 0x1fff;
+  half += remainder > 0x1000 || (remainder == 0x1000 && (half & 1));
+  return sign | (uint16_t)half;
+}
+
+float float_from_half(const uint16_t half) {
+  const uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  const uint32_t mantissa = half & 0x3ff;
+  if (exponent == 0) {
+    const float magnitude = ldexpf((float)mantissa, -24);
+    return sign != 0 ? -magnitude : magnitude;
+  }
+  const uint32_t bits = exponent == 0x1f
+                        ? sign | 0x7f800000 | (mantissa << 13)
+                        : sign | ((exponent + 112) << 23) | (mantissa << 13);
+  float value;
+  memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+int16_t snorm16_from_float(const float value) {
+  const float clamped = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+  return (int16_t)lrintf(clamped * 32767.0f);
+}
+
+float float_from_snorm16(const int16_t value) {
+  // -32768 and -32767 both map to -1
+  const float normalized = (float)value / 32767.0f;
+  return normalized < -1.0f ? -1.0f : normalized;
+}
@@ -0,0 +1,16 @@
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include <stdint.h>
+
+// ieee 754 half precision, rounds to nearest even (matches
+// SG_VERTEXFORMAT_HALF2/HALF4)
+uint16_t half_from_float(float value);
+float float_from_half(uint16_t half);
+
+// value in [-1, 1] as a normalized signed 16-bit integer (matches
+// SG_VERTEXFORMAT_SHORT2N/SHORT4N)
+int16_t snorm16_from_float(float value);
+float float_from_snorm16(int16_t value);
+
+#endif // QUANTIZE_H
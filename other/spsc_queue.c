@@ -0,0 +1,65 @@
+#include "spsc_queue.h"
+
+#include <SDL.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// keeps the indices written by each side on their own cache line
+#define SpscQueueCacheLineSize 64
+
+struct spsc_queue_t {
+  // next slot to pop, written by the consumer
+  SDL_atomic_t head;
+  char head_padding[SpscQueueCacheLineSize - sizeof(SDL_atomic_t)];
+  // next slot to push, written by the producer
+  SDL_atomic_t tail;
+  char tail_padding[SpscQueueCacheLineSize - sizeof(SDL_atomic_t)];
+  void** items;
+  uint32_t mask;
+};
+
+spsc_queue_t* spsc_queue_create(const int capacity) {
+  uint32_t size = 1;
+  while (size < (uint32_t)capacity) {
+    size <<= 1;
+  }
+  spsc_queue_t* queue = calloc(1, sizeof(spsc_queue_t));
+  queue->items = calloc(size, sizeof(void*));
+  queue->mask = size - 1;
+  return queue;
+}
+
+void spsc_queue_destroy(spsc_queue_t* queue) {
+  if (queue == NULL) {
+    return;
+  }
+  free(queue->items);
+  free(queue);
+}
+
+// indices wrap around, only their difference (the number of queued items)
+// and their low bits (the slot) are used
+bool spsc_queue_push(spsc_queue_t* queue, void* item) {
+  const uint32_t tail = (uint32_t)SDL_AtomicGet(&queue->tail);
+  const uint32_t head = (uint32_t)SDL_AtomicGet(&queue->head);
+  if (tail - head > queue->mask) {
+    return false;
+  }
+  queue->items[tail & queue->mask] = item;
+  // publishes the item (SDL atomics are full barriers)
+  SDL_AtomicSet(&queue->tail, (int)(tail + 1));
+  return true;
+}
+
+bool spsc_queue_pop(spsc_queue_t* queue, void** item) {
+  const uint32_t head = (uint32_t)SDL_AtomicGet(&queue->head);
+  const uint32_t tail = (uint32_t)SDL_AtomicGet(&queue->tail);
+  if (head == tail) {
+    return false;
+  }
+  *item = queue->items[head & queue->mask];
+  // hands the slot back to the producer
+  SDL_AtomicSet(&queue->head, (int)(head + 1));
+  return true;
+}
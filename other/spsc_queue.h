@@ -0,0 +1,19 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdbool.h>
+
+// bounded queue of pointers for exactly one producer and one consumer
+// thread, push and pop never lock or block
+typedef struct spsc_queue_t spsc_queue_t;
+
+// capacity is rounded up to a power of two
+spsc_queue_t* spsc_queue_create(int capacity);
+void spsc_queue_destroy(spsc_queue_t* queue);
+
+// producer only, returns false when the queue is full
+bool spsc_queue_push(spsc_queue_t* queue, void* item);
+// consumer only, returns false when the queue is empty
+bool spsc_queue_pop(spsc_queue_t* queue, void** item);
+
+#endif // SPSC_QUEUE_H
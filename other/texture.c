@@ -1,18 +1,185 @@
 #include "texture.h"
 
+#include "block_cache.h"
+#include "job_pool.h"
+#include "mip_cache.h"
+#include "png_decode.h"
+
+#include <SDL.h>
+
 #include <stdio.h>
+#include <stdlib.h>
+
+static double elapsed_ms(const uint64_t begin_counter) {
+  return (double)(SDL_GetPerformanceCounter() - begin_counter) * 1000.0
+       / (double)SDL_GetPerformanceFrequency();
+}
+
+// the levels are only cached when kept as they are (blocks replace them
+// when compressed, see compress_levels), source_stamp is NULL then
+static mip_chain_t load_mip_chain(
+  const char* filename, const file_stamp_t* source_stamp,
+  const uint32_t* pixels, const int width, const int height) {
+  char cache_path[1024];
+  mip_cache_path(filename, cache_path, sizeof cache_path);
+  mip_chain_t mips;
+  if (
+    source_stamp != NULL
+    && mip_cache_load(cache_path, source_stamp, width, height, &mips)) {
+    return mips;
+  }
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+  mips = build_mip_chain(pixels, width, height);
+  const double build_ms = elapsed_ms(begin_counter);
+  printf(
+    "Built %d mip levels for %s in %.2fms (%.1f MP/s)\n", mips.level_count,
+    filename, build_ms,
+    build_ms > 0.0 ? (double)width * height / (build_ms * 1000.0) : 0.0);
+  if (
+    source_stamp != NULL
+    && !mip_cache_save(cache_path, source_stamp, &mips)) {
+    printf("Failed to write mip cache: %s\n", cache_path);
+  }
+  return mips;
+}
 
-texture_t load_png_texture(const char* filename) {
-  upng_t* texture = upng_new_from_file(filename);
-  if (texture != NULL) {
-    upng_decode(texture);
-    if (upng_get_error(texture) == UPNG_EOK) {
-      return (texture_t){
-        .png_texture = texture,
-        .color_buffer = (uint32_t*)upng_get_buffer(texture),
-        .width = (int)upng_get_width(texture),
-        .height = (int)upng_get_height(texture)};
+static const char* block_format_name(const block_format_e format) {
+  return format == block_format_bc3 ? "BC3" : "BC1";
+}
+
+static bool decode_png(const char* filename, texture_t* texture) {
+  mapped_file_t file;
+  if (mapped_file_open(&file, filename)) {
+    texture->color_buffer = png_decode(
+      (const uint8_t*)file.data, file.size, &texture->width,
+      &texture->height);
+    mapped_file_close(&file);
+    if (texture->color_buffer != NULL) {
+      return true;
     }
   }
-  return (texture_t){0};
+  // formats png_decode doesn't handle
+  upng_t* png = upng_new_from_file(filename);
+  if (png == NULL) {
+    return false;
+  }
+  upng_decode(png);
+  if (upng_get_error(png) != UPNG_EOK) {
+    upng_free(png);
+    return false;
+  }
+  texture->png_texture = png;
+  texture->color_buffer = (uint32_t*)upng_get_buffer(png);
+  texture->width = (int)upng_get_width(png);
+  texture->height = (int)upng_get_height(png);
+  return true;
+}
+
+// the blocks are not cached without source_stamp
+static void compress_levels(
+  const char* filename, const char* cache_path,
+  const file_stamp_t* source_stamp, texture_t* texture,
+  const double png_load_ms, job_pool_t* pool) {
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+  const size_t pixel_count = (size_t)texture->width * texture->height;
+  const block_format_e format =
+    select_block_format(texture->color_buffer, pixel_count);
+  texture->compressed = compress_texture(
+    format, texture->color_buffer, texture->width, texture->height,
+    &texture->mips, pool);
+  const double encode_ms = elapsed_ms(begin_counter);
+  const size_t rgba_bytes =
+    (pixel_count + texture->mips.pixel_count) * sizeof(uint32_t);
+  printf(
+    "Compressed %s to %s in %.2fms on %d threads, %.1f MB to %.1f MB "
+    "(%.1f:1 with mips)\n",
+    filename, block_format_name(format), encode_ms,
+    pool != NULL ? job_pool_thread_count(pool) : 1,
+    (double)rgba_bytes / (1024.0 * 1024.0),
+    (double)texture->compressed.size / (1024.0 * 1024.0),
+    (double)rgba_bytes / (double)texture->compressed.size);
+  if (
+    source_stamp != NULL
+    && !block_cache_save(
+      cache_path, source_stamp, &texture->compressed, png_load_ms,
+      encode_ms)) {
+    printf("Failed to write block cache: %s\n", cache_path);
+  }
+  // the blocks replace the levels
+  free_mip_chain(&texture->mips);
+}
+
+texture_t load_png_texture(
+  const char* filename, const texture_import_options_t* options,
+  job_pool_t* pool) {
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+  texture_t texture = {.cpu_sampled = options->cpu_sampled};
+
+  // taken before the png is read, the caches are skipped without it
+  file_stamp_t source_stamp;
+  const bool stamped = file_stamp(filename, &source_stamp);
+
+  char cache_path[1024];
+  block_cache_path(filename, cache_path, sizeof cache_path);
+  double png_load_ms;
+  double encode_ms;
+  const bool cached =
+    options->block_compress && stamped
+    && block_cache_load(
+      cache_path, &source_stamp, &texture.compressed, &png_load_ms,
+      &encode_ms);
+  if (cached) {
+    texture.width = texture.compressed.widths[0];
+    texture.height = texture.compressed.heights[0];
+    printf(
+      "Loaded %s (%s) in %.2fms (png path %.2fms, encode %.2fms)\n",
+      cache_path, block_format_name(texture.compressed.format),
+      elapsed_ms(begin_counter), png_load_ms, encode_ms);
+    if (!options->cpu_sampled) {
+      return texture;
+    }
+  }
+
+  if (
+    !decode_png(filename, &texture)
+    || (cached
+        && (texture.width != texture.compressed.widths[0]
+            || texture.height != texture.compressed.heights[0]))) {
+    free_texture(&texture);
+    return (texture_t){0};
+  }
+  if (cached) {
+    return texture;
+  }
+  const bool encode = options->block_compress && !options->cached_blocks_only;
+  const file_stamp_t* cache_stamp = stamped ? &source_stamp : NULL;
+  texture.mips = load_mip_chain(
+    filename, !encode ? cache_stamp : NULL, texture.color_buffer,
+    texture.width, texture.height);
+  if (encode) {
+    compress_levels(
+      filename, cache_path, cache_stamp, &texture, elapsed_ms(begin_counter),
+      pool);
+  }
+  return texture;
+}
+
+void release_texture_pixels(texture_t* texture) {
+  if (!texture->cpu_sampled) {
+    free_texture(texture);
+    return;
+  }
+  free_compressed_texture(&texture->compressed);
+}
+
+void free_texture(texture_t* texture) {
+  if (texture->png_texture != NULL) {
+    upng_free(texture->png_texture);
+  } else {
+    free(texture->color_buffer);
+  }
+  free_mip_chain(&texture->mips);
+  free_compressed_texture(&texture->compressed);
+  texture->png_texture = NULL;
+  texture->color_buffer = NULL;
 }
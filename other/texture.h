@@ -1,6 +1,10 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include "block_compress.h"
+#include "mipmap.h"
+
+#include <stdbool.h>
 #include <stdint.h>
 #include <upng.h>
 
@@ -9,13 +13,47 @@ typedef struct tex2f_t {
   float v;
 } tex2f_t;
 
+typedef struct job_pool_t job_pool_t;
+
+typedef struct texture_import_options_t {
+  // compresses the levels into 4x4 blocks (bc1, bc3 with alpha) cached next
+  // to the file (see block_cache.h), the png is not decoded once cached
+  bool block_compress;
+  // with block_compress, uploads the levels uncompressed instead of encoding
+  // them when the cache is missing or stale (no encode on the calling thread)
+  bool cached_blocks_only;
+  // keeps color_buffer after upload for sampling on the cpu (decoded even
+  // when the blocks are cached)
+  bool cpu_sampled;
+} texture_import_options_t;
+
 typedef struct texture_t {
+  // set (and owning color_buffer) when decoded by upng, for the formats
+  // png_decode does not handle
   upng_t* png_texture;
-  uint32_t* color_buffer;
+  uint32_t* color_buffer; // NULL once released
   int width;
   int height;
+  // levels below color_buffer, released with it
+  mip_chain_t mips;
+  // every level when block compressed (mips is then empty), released with
+  // color_buffer
+  compressed_texture_t compressed;
+  // keeps color_buffer after upload for sampling on the cpu
+  bool cpu_sampled;
 } texture_t;
 
-texture_t load_png_texture(const char* filename);
+// decoded with png_decode (upng for the formats it does not handle),
+// the mip chain is loaded from a cache next to the file (see mip_cache.h)
+// or built and cached, blocks are encoded across the pool (optional)
+// a texture failed to load when its width is 0
+texture_t load_png_texture(
+  const char* filename, const texture_import_options_t* options,
+  job_pool_t* pool);
+// frees the blocks and the decoded pixels unless the texture is cpu sampled
+// (the size is kept), call once they were uploaded
+void release_texture_pixels(texture_t* texture);
+// frees the blocks and the decoded pixels, cpu sampled or not
+void free_texture(texture_t* texture);
 
 #endif // TEXTURE_H
@@ -0,0 +1,302 @@
+#include "texture_residency.h"
+
+#include "array.h"
+
+#include <SDL.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct resident_texture_t {
+  const char* path;
+  texture_import_options_t options; // to restore the texture
+  sg_image image; // SG_INVALID_ID while evicted
+  bool dynamic; // uncompressed, can be updated in place
+  int width;
+  int height;
+  size_t bytes; // of every mip level
+  uint64_t last_used_frame;
+  bool restore_failed; // not retried until the texture is updated
+  bool removed; // free slot
+} resident_texture_t;
+
+struct texture_residency_t {
+  resident_texture_t* textures; // indexed by id
+  size_t budget_bytes;
+  size_t resident_bytes;
+  uint64_t frame;
+  int eviction_count;
+  int restore_count;
+};
+
+static sg_image_data image_data(const texture_t* texture) {
+  sg_image_data data = {
+    .subimage[0][0] = (sg_range){
+      .ptr = texture->color_buffer,
+      .size = (size_t)texture->width * texture->height * sizeof(uint32_t)}};
+  const mip_chain_t* mips = &texture->mips;
+  for (int l = 1; l < mips->level_count; l++) {
+    data.subimage[0][l] = (sg_range){
+      .ptr = mips->pixels + mips->offsets[l],
+      .size = (size_t)mips->widths[l] * mips->heights[l] * sizeof(uint32_t)};
+  }
+  return data;
+}
+
+static sg_pixel_format block_pixel_format(const block_format_e format) {
+  return format == block_format_bc3 ? SG_PIXELFORMAT_BC3_RGBA
+                                    : SG_PIXELFORMAT_BC1_RGBA;
+}
+
+static sg_filter min_filter(const int level_count) {
+  return level_count > 1 ? SG_FILTER_LINEAR_MIPMAP_LINEAR : SG_FILTER_NEAREST;
+}
+
+// compressed images are immutable, created with every level
+static void make_compressed_image(
+  resident_texture_t* resident, const compressed_texture_t* compressed) {
+  sg_image_data data = {0};
+  for (int l = 0; l < compressed->level_count; l++) {
+    data.subimage[0][l] = (sg_range){
+      .ptr = compressed->data + compressed->offsets[l],
+      .size = compressed->sizes[l]};
+  }
+  resident->image = sg_make_image(&(sg_image_desc){
+    .width = compressed->widths[0],
+    .height = compressed->heights[0],
+    .num_mipmaps = compressed->level_count,
+    .pixel_format = block_pixel_format(compressed->format),
+    .min_filter = min_filter(compressed->level_count),
+    .data = data,
+    .label = "texture"});
+  resident->dynamic = false;
+  resident->bytes = compressed->size;
+}
+
+static void make_dynamic_image(
+  resident_texture_t* resident, const int width, const int height,
+  const int level_count, const sg_image_data* data) {
+  resident->image = sg_make_image(&(sg_image_desc){
+    .width = width,
+    .height = height,
+    .num_mipmaps = level_count,
+    .min_filter = min_filter(level_count),
+    .usage = SG_USAGE_DYNAMIC,
+    .label = "texture"});
+  // dynamic images can't be created with data
+  sg_update_image(resident->image, data);
+  resident->dynamic = true;
+  resident->bytes = 0;
+  for (int l = 0; l < level_count; l++) {
+    resident->bytes += data->subimage[0][l].size;
+  }
+}
+
+// the device can't sample the blocks, upload them decompressed
+static void make_decompressed_image(
+  resident_texture_t* resident, const compressed_texture_t* compressed) {
+  size_t pixel_count = 0;
+  for (int l = 0; l < compressed->level_count; l++) {
+    pixel_count += (size_t)compressed->widths[l] * compressed->heights[l];
+  }
+  uint32_t* pixels = malloc(pixel_count * sizeof(uint32_t));
+  sg_image_data data = {0};
+  uint32_t* level_pixels = pixels;
+  for (int l = 0; l < compressed->level_count; l++) {
+    const size_t level_pixel_count =
+      (size_t)compressed->widths[l] * compressed->heights[l];
+    decompress_texture_level(compressed, l, level_pixels);
+    data.subimage[0][l] = (sg_range){
+      .ptr = level_pixels, .size = level_pixel_count * sizeof(uint32_t)};
+    level_pixels += level_pixel_count;
+  }
+  make_dynamic_image(
+    resident, compressed->widths[0], compressed->heights[0],
+    compressed->level_count, &data);
+  free(pixels);
+}
+
+// sets the image, size and bytes of resident
+static void make_image(resident_texture_t* resident, const texture_t* texture) {
+  const compressed_texture_t* compressed = &texture->compressed;
+  if (compressed->level_count > 0) {
+    if (sg_query_pixelformat(block_pixel_format(compressed->format)).sample) {
+      make_compressed_image(resident, compressed);
+    } else {
+      make_decompressed_image(resident, compressed);
+    }
+  } else {
+    const sg_image_data data = image_data(texture);
+    make_dynamic_image(
+      resident, texture->width, texture->height,
+      texture->mips.level_count > 0 ? texture->mips.level_count : 1, &data);
+  }
+  resident->width = texture->width;
+  resident->height = texture->height;
+}
+
+static void destroy_image(
+  texture_residency_t* residency, resident_texture_t* texture) {
+  if (texture->image.id == SG_INVALID_ID) {
+    return;
+  }
+  sg_destroy_image(texture->image);
+  texture->image = (sg_image){SG_INVALID_ID};
+  residency->resident_bytes -= texture->bytes;
+}
+
+// least recently used first, textures used this frame are never evicted
+// (the budget is exceeded instead)
+static void evict_over_budget(texture_residency_t* residency) {
+  while (residency->resident_bytes > residency->budget_bytes) {
+    resident_texture_t* oldest = NULL;
+    for (size_t t = 0; t < array_length(residency->textures); t++) {
+      resident_texture_t* texture = &residency->textures[t];
+      if (
+        texture->removed || texture->image.id == SG_INVALID_ID
+        || texture->last_used_frame == residency->frame) {
+        continue;
+      }
+      if (
+        oldest == NULL
+        || texture->last_used_frame < oldest->last_used_frame) {
+        oldest = texture;
+      }
+    }
+    if (oldest == NULL) {
+      return;
+    }
+    printf(
+      "Evicted %s (%.1f MB)\n", oldest->path,
+      (double)oldest->bytes / (1024.0 * 1024.0));
+    destroy_image(residency, oldest);
+    residency->eviction_count++;
+  }
+}
+
+texture_residency_t* texture_residency_create(const size_t budget_bytes) {
+  texture_residency_t* residency = calloc(1, sizeof(texture_residency_t));
+  residency->budget_bytes = budget_bytes;
+  return residency;
+}
+
+void texture_residency_destroy(texture_residency_t* residency) {
+  if (residency == NULL) {
+    return;
+  }
+  for (size_t t = 0; t < array_length(residency->textures); t++) {
+    destroy_image(residency, &residency->textures[t]);
+  }
+  array_free(residency->textures);
+  free(residency);
+}
+
+void texture_residency_set_budget(
+  texture_residency_t* residency, const size_t budget_bytes) {
+  residency->budget_bytes = budget_bytes;
+  evict_over_budget(residency);
+}
+
+void texture_residency_begin_frame(texture_residency_t* residency) {
+  residency->frame++;
+}
+
+int texture_residency_add(
+  texture_residency_t* residency, const char* path,
+  const texture_import_options_t* options, const texture_t* texture) {
+  // ids are ints, indices of textures
+  const int count = (int)array_length(residency->textures);
+  int id = -1;
+  for (int t = 0; t < count; t++) {
+    if (residency->textures[t].removed) {
+      id = t;
+      break;
+    }
+  }
+  if (id < 0) {
+    id = count;
+    residency->textures =
+      array_hold(residency->textures, 1, sizeof(resident_texture_t));
+  }
+  resident_texture_t* resident = &residency->textures[id];
+  *resident = (resident_texture_t){
+    .path = path, .options = *options, .last_used_frame = residency->frame};
+  make_image(resident, texture);
+  residency->resident_bytes += residency->textures[id].bytes;
+  evict_over_budget(residency);
+  return id;
+}
+
+void texture_residency_update(
+  texture_residency_t* residency, const int id, const texture_t* texture) {
+  resident_texture_t* resident = &residency->textures[id];
+  resident->last_used_frame = residency->frame;
+  resident->restore_failed = false;
+  // the same size implies the same mip levels
+  if (
+    resident->image.id != SG_INVALID_ID && resident->dynamic
+    && texture->compressed.level_count == 0
+    && resident->width == texture->width
+    && resident->height == texture->height) {
+    const sg_image_data data = image_data(texture);
+    sg_update_image(resident->image, &data);
+    return;
+  }
+  destroy_image(residency, resident);
+  make_image(resident, texture);
+  residency->resident_bytes += resident->bytes;
+  evict_over_budget(residency);
+}
+
+void texture_residency_remove(texture_residency_t* residency, const int id) {
+  destroy_image(residency, &residency->textures[id]);
+  residency->textures[id] = (resident_texture_t){.removed = true};
+}
+
+sg_image texture_residency_use(texture_residency_t* residency, const int id) {
+  resident_texture_t* resident = &residency->textures[id];
+  resident->last_used_frame = residency->frame;
+  if (resident->image.id != SG_INVALID_ID || resident->restore_failed) {
+    return resident->image;
+  }
+  const uint64_t begin_counter = SDL_GetPerformanceCounter();
+  // restoring happens mid frame, a missing or stale block cache falls back
+  // to an uncompressed image instead of encoding (the loader encodes)
+  texture_import_options_t options = resident->options;
+  options.cached_blocks_only = true;
+  texture_t texture = load_png_texture(resident->path, &options, NULL);
+  if (texture.width == 0) {
+    printf("Failed to restore %s\n", resident->path);
+    resident->restore_failed = true;
+    return resident->image;
+  }
+  make_image(resident, &texture);
+  free_texture(&texture);
+  residency->resident_bytes += resident->bytes;
+  residency->restore_count++;
+  printf(
+    "Restored %s in %.2fms\n", resident->path,
+    (double)(SDL_GetPerformanceCounter() - begin_counter) * 1000.0
+      / (double)SDL_GetPerformanceFrequency());
+  evict_over_budget(residency);
+  return resident->image;
+}
+
+texture_residency_stats_t texture_residency_stats(
+  const texture_residency_t* residency) {
+  texture_residency_stats_t stats = {
+    .resident_bytes = residency->resident_bytes,
+    .budget_bytes = residency->budget_bytes,
+    .eviction_count = residency->eviction_count,
+    .restore_count = residency->restore_count};
+  for (size_t t = 0; t < array_length(residency->textures); t++) {
+    const resident_texture_t* texture = &residency->textures[t];
+    if (texture->removed) {
+      continue;
+    }
+    stats.texture_count++;
+    stats.resident_count += texture->image.id != SG_INVALID_ID ? 1 : 0;
+  }
+  return stats;
+}
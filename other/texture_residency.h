@@ -0,0 +1,55 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include "texture.h"
+
+#include <sokol_gfx.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// owns gpu images and keeps their total size within a budget by destroying
+// the least recently used ones, an evicted image is loaded again from its
+// file (on the calling thread) the next time it's used, from the block
+// cache or uncompressed (blocks are never encoded while restoring)
+// block compressed textures are uploaded as bc1/bc3 when the device samples
+// them and decompressed to rgba8 otherwise
+typedef struct texture_residency_t texture_residency_t;
+
+typedef struct texture_residency_stats_t {
+  size_t resident_bytes;
+  size_t budget_bytes;
+  int resident_count;
+  int texture_count;
+  int eviction_count; // since creation
+  int restore_count;
+} texture_residency_stats_t;
+
+texture_residency_t* texture_residency_create(size_t budget_bytes);
+// destroys every image
+void texture_residency_destroy(texture_residency_t* residency);
+// evicts until the budget is met (images used this frame are kept)
+void texture_residency_set_budget(
+  texture_residency_t* residency, size_t budget_bytes);
+// textures used from now on count as used in a new frame
+void texture_residency_begin_frame(texture_residency_t* residency);
+
+// creates an image from the pixels or blocks of texture (path must outlive
+// the entry, it's loaded again with options after an eviction) and returns
+// its id, uncompressed images are dynamic so they can be updated in place
+int texture_residency_add(
+  texture_residency_t* residency, const char* path,
+  const texture_import_options_t* options, const texture_t* texture);
+// replaces the pixels, in place when the size matches and both are
+// uncompressed
+void texture_residency_update(
+  texture_residency_t* residency, int id, const texture_t* texture);
+void texture_residency_remove(texture_residency_t* residency, int id);
+// marks the texture used this frame and returns its image, restoring it
+// first when it was evicted (SG_INVALID_ID if that fails)
+sg_image texture_residency_use(texture_residency_t* residency, int id);
+
+texture_residency_stats_t texture_residency_stats(
+  const texture_residency_t* residency);
+
+#endif // TEXTURE_RESIDENCY_H
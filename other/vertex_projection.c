@@ -0,0 +1,438 @@
+#include "vertex_projection.h"
+
+#include "array.h"
+#include "quantize.h"
+
+#include <string.h>
+
+#if defined(__AVX__)
+#define PROJECTION_AVX
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROJECTION_SSE2
+#include <emmintrin.h>
+#endif
+
+#define ProjectionCacheLineSize 64
+// fewest vertices worth handing to another thread
+#define MinProjectionJobVertexCount 16384
+
+position_blocks_t build_position_blocks(
+  const float* vertices, const int vertex_count) {
+  const int block_count =
+    (vertex_count + ProjectionBlockSize - 1) / ProjectionBlockSize;
+  float* positions = array_hold(
+    NULL, (size_t)block_count * 3 * ProjectionBlockSize, sizeof(float));
+  for (int b = 0; b < block_count; b++) {
+    float* block = &positions[(size_t)b * 3 * ProjectionBlockSize];
+    for (int l = 0; l < ProjectionBlockSize; l++) {
+      const int v = b * ProjectionBlockSize + l < vertex_count
+                    ? b * ProjectionBlockSize + l
+                    : vertex_count - 1;
+      for (int a = 0; a < 3; a++) {
+        block[a * ProjectionBlockSize + l] = vertices[v * 3 + a];
+      }
+    }
+  }
+  return (position_blocks_t){
+    .positions = positions,
+    .vertex_count = vertex_count,
+    .block_count = block_count};
+}
+
+void free_position_blocks(position_blocks_t* blocks) {
+  array_free(blocks->positions);
+  *blocks = (position_blocks_t){0};
+}
+
+vertex_projection_t make_vertex_projection(
+  const as_mat34f* model, const as_mat34f* view, const as_mat44f* projection) {
+  const as_mat34f model_view = as_mat34f_mul_mat34f_v(*view, *model);
+  const as_mat44f model_view_projection =
+    as_mat44f_mul_mat44f_v(*projection, as_mat44f_from_mat34f(&model_view));
+  vertex_projection_t result;
+  memcpy(
+    result.model_view_projection, model_view_projection.elem,
+    sizeof result.model_view_projection);
+  memcpy(
+    result.model_view_depth, &model_view.elem[8],
+    sizeof result.model_view_depth);
+  return result;
+}
+
+// where project_position_blocks writes
+typedef struct projection_output_t {
+  uint8_t* positions;
+  int position_stride;
+  uint8_t* depth_recips; // NULL to skip them
+  int depth_recip_stride;
+  bool half_depth_recips;
+} projection_output_t;
+
+// projected vertices of one block, lane by lane
+typedef struct projected_block_t {
+  float x[ProjectionBlockSize];
+  float y[ProjectionBlockSize];
+  float z[ProjectionBlockSize];
+  float depth_recips[ProjectionBlockSize];
+  uint32_t half_depth_recips[ProjectionBlockSize];
+} projected_block_t;
+
+static void write_projected_block(
+  const projected_block_t* block, const int first_vertex,
+  const int vertex_count, const projection_output_t* output) {
+  uint8_t* position = output->positions
+                    + (size_t)first_vertex * output->position_stride;
+  for (int l = 0; l < vertex_count; l++) {
+    const float projected[] = {block->x[l], block->y[l], block->z[l]};
+    memcpy(position, projected, sizeof projected);
+    position += output->position_stride;
+  }
+  if (output->depth_recips == NULL) {
+    return;
+  }
+  uint8_t* depth_recip = output->depth_recips
+                       + (size_t)first_vertex * output->depth_recip_stride;
+  for (int l = 0; l < vertex_count; l++) {
+    if (output->half_depth_recips) {
+      const uint16_t half_depth_recip[] = {
+        (uint16_t)block->half_depth_recips[l], 0};
+      memcpy(depth_recip, half_depth_recip, sizeof half_depth_recip);
+    } else {
+      memcpy(depth_recip, &block->depth_recips[l], sizeof(float));
+    }
+    depth_recip += output->depth_recip_stride;
+  }
+}
+
+static void project_block_scalar(
+  const float* positions, const vertex_projection_t* projection,
+  const projection_output_t* output, projected_block_t* block) {
+  const float* m = projection->model_view_projection;
+  const float* d = projection->model_view_depth;
+  for (int l = 0; l < ProjectionBlockSize; l++) {
+    const float x = positions[l];
+    const float y = positions[ProjectionBlockSize + l];
+    const float z = positions[2 * ProjectionBlockSize + l];
+    float clip[4];
+    for (int r = 0; r < 4; r++) {
+      clip[r] = m[r * 4] * x + m[r * 4 + 1] * y + m[r * 4 + 2] * z
+              + m[r * 4 + 3];
+    }
+    const float w_recip = 1.0f / clip[3];
+    block->x[l] = clip[0] * w_recip;
+    block->y[l] = clip[1] * w_recip;
+    block->z[l] = clip[2] * w_recip;
+    if (output->depth_recips == NULL) {
+      continue;
+    }
+    block->depth_recips[l] = 1.0f / (d[0] * x + d[1] * y + d[2] * z + d[3]);
+    if (output->half_depth_recips) {
+      block->half_depth_recips[l] = half_from_float(block->depth_recips[l]);
+    }
+  }
+}
+
+#ifdef PROJECTION_SSE2
+// half_from_float four lanes at a time (halves in the low 16 bits), after
+// Giesen's float_to_half_fast3_rtne
+static __m128i half_from_float_sse2(const __m128 value) {
+  const __m128i bits = _mm_castps_si128(value);
+  const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(INT32_MIN));
+  const __m128i magnitude = _mm_xor_si128(bits, sign);
+  // subnormal (or zero) halves, adding 0.5 moves the half mantissa to the
+  // bottom of the float mantissa rounding to nearest even
+  const __m128 half_magic = _mm_set1_ps(0.5f);
+  const __m128i subnormal = _mm_sub_epi32(
+    _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), half_magic)),
+    _mm_castps_si128(half_magic));
+  // normal halves, the exponent is rebiased (by (15 - 127) << 23) and the
+  // mantissa rounded to nearest even before dropping its low bits
+  const __m128i odd =
+    _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(1));
+  const __m128i normal = _mm_srli_epi32(
+    _mm_add_epi32(
+      _mm_add_epi32(magnitude, _mm_set1_epi32((int32_t)0xc8000fffu)), odd),
+    13);
+  const __m128i is_subnormal =
+    _mm_cmplt_epi32(magnitude, _mm_set1_epi32(113 << 23));
+  __m128i half = _mm_or_si128(
+    _mm_and_si128(is_subnormal, subnormal),
+    _mm_andnot_si128(is_subnormal, normal));
+  // too large or infinite, nan
+  const __m128i is_large =
+    _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x477fffff));
+  const __m128i is_nan =
+    _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7f800000));
+  const __m128i large = _mm_or_si128(
+    _mm_set1_epi32(0x7c00), _mm_and_si128(is_nan, _mm_set1_epi32(0x0200)));
+  half = _mm_or_si128(
+    _mm_and_si128(is_large, large), _mm_andnot_si128(is_large, half));
+  return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+}
+#endif
+
+#if defined(PROJECTION_AVX)
+// one register of eight lanes per coordinate
+
+static void project_block_avx(
+  const float* positions, const __m256 m[16], const __m256 d[4],
+  const projection_output_t* output, projected_block_t* block) {
+  const __m256 x = _mm256_load_ps(positions);
+  const __m256 y = _mm256_load_ps(positions + ProjectionBlockSize);
+  const __m256 z = _mm256_load_ps(positions + 2 * ProjectionBlockSize);
+  __m256 clip[4];
+  for (int r = 0; r < 4; r++) {
+    clip[r] = _mm256_add_ps(
+      _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_mul_ps(m[r * 4], x), _mm256_mul_ps(m[r * 4 + 1], y)),
+        _mm256_mul_ps(m[r * 4 + 2], z)),
+      m[r * 4 + 3]);
+  }
+  const __m256 w_recip = _mm256_div_ps(_mm256_set1_ps(1.0f), clip[3]);
+  _mm256_storeu_ps(block->x, _mm256_mul_ps(clip[0], w_recip));
+  _mm256_storeu_ps(block->y, _mm256_mul_ps(clip[1], w_recip));
+  _mm256_storeu_ps(block->z, _mm256_mul_ps(clip[2], w_recip));
+  if (output->depth_recips == NULL) {
+    return;
+  }
+  const __m256 depth = _mm256_add_ps(
+    _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(d[0], x), _mm256_mul_ps(d[1], y)),
+      _mm256_mul_ps(d[2], z)),
+    d[3]);
+  const __m256 depth_recips = _mm256_div_ps(_mm256_set1_ps(1.0f), depth);
+  _mm256_storeu_ps(block->depth_recips, depth_recips);
+  if (output->half_depth_recips) {
+    // avx has no 256-bit integer operations
+    _mm_storeu_si128(
+      (__m128i*)block->half_depth_recips,
+      half_from_float_sse2(_mm256_castps256_ps128(depth_recips)));
+    _mm_storeu_si128(
+      (__m128i*)&block->half_depth_recips[4],
+      half_from_float_sse2(_mm256_extractf128_ps(depth_recips, 1)));
+  }
+}
+
+static void project_blocks_avx(
+  const position_blocks_t* blocks, const int begin_block, const int end_block,
+  const vertex_projection_t* projection, const projection_output_t* output) {
+  __m256 m[16];
+  for (int e = 0; e < 16; e++) {
+    m[e] = _mm256_set1_ps(projection->model_view_projection[e]);
+  }
+  __m256 d[4];
+  for (int e = 0; e < 4; e++) {
+    d[e] = _mm256_set1_ps(projection->model_view_depth[e]);
+  }
+  projected_block_t block;
+  for (int b = begin_block; b < end_block; b++) {
+    project_block_avx(
+      &blocks->positions[(size_t)b * 3 * ProjectionBlockSize], m, d, output,
+      &block);
+    const int first_vertex = b * ProjectionBlockSize;
+    const int remaining = blocks->vertex_count - first_vertex;
+    write_projected_block(
+      &block, first_vertex,
+      remaining < ProjectionBlockSize ? remaining : ProjectionBlockSize,
+      output);
+  }
+}
+#elif defined(PROJECTION_SSE2)
+// one register of four lanes per coordinate, two per block
+
+static void project_block_sse2(
+  const float* positions, const __m128 m[16], const __m128 d[4],
+  const projection_output_t* output, projected_block_t* block) {
+  for (int h = 0; h < ProjectionBlockSize; h += 4) {
+    const __m128 x = _mm_load_ps(positions + h);
+    const __m128 y = _mm_load_ps(positions + ProjectionBlockSize + h);
+    const __m128 z = _mm_load_ps(positions + 2 * ProjectionBlockSize + h);
+    __m128 clip[4];
+    for (int r = 0; r < 4; r++) {
+      clip[r] = _mm_add_ps(
+        _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(m[r * 4], x), _mm_mul_ps(m[r * 4 + 1], y)),
+          _mm_mul_ps(m[r * 4 + 2], z)),
+        m[r * 4 + 3]);
+    }
+    const __m128 w_recip = _mm_div_ps(_mm_set1_ps(1.0f), clip[3]);
+    _mm_storeu_ps(&block->x[h], _mm_mul_ps(clip[0], w_recip));
+    _mm_storeu_ps(&block->y[h], _mm_mul_ps(clip[1], w_recip));
+    _mm_storeu_ps(&block->z[h], _mm_mul_ps(clip[2], w_recip));
+    if (output->depth_recips == NULL) {
+      continue;
+    }
+    const __m128 depth = _mm_add_ps(
+      _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(d[0], x), _mm_mul_ps(d[1], y)),
+        _mm_mul_ps(d[2], z)),
+      d[3]);
+    const __m128 depth_recips = _mm_div_ps(_mm_set1_ps(1.0f), depth);
+    _mm_storeu_ps(&block->depth_recips[h], depth_recips);
+    if (output->half_depth_recips) {
+      _mm_storeu_si128(
+        (__m128i*)&block->half_depth_recips[h],
+        half_from_float_sse2(depth_recips));
+    }
+  }
+}
+
+static void project_blocks_sse2(
+  const position_blocks_t* blocks, const int begin_block, const int end_block,
+  const vertex_projection_t* projection, const projection_output_t* output) {
+  __m128 m[16];
+  for (int e = 0; e < 16; e++) {
+    m[e] = _mm_set1_ps(projection->model_view_projection[e]);
+  }
+  __m128 d[4];
+  for (int e = 0; e < 4; e++) {
+    d[e] = _mm_set1_ps(projection->model_view_depth[e]);
+  }
+  projected_block_t block;
+  for (int b = begin_block; b < end_block; b++) {
+    project_block_sse2(
+      &blocks->positions[(size_t)b * 3 * ProjectionBlockSize], m, d, output,
+      &block);
+    const int first_vertex = b * ProjectionBlockSize;
+    const int remaining = blocks->vertex_count - first_vertex;
+    write_projected_block(
+      &block, first_vertex,
+      remaining < ProjectionBlockSize ? remaining : ProjectionBlockSize,
+      output);
+  }
+}
+#endif
+
+static void project_blocks_scalar(
+  const position_blocks_t* blocks, const int begin_block, const int end_block,
+  const vertex_projection_t* projection, const projection_output_t* output) {
+  projected_block_t block;
+  for (int b = begin_block; b < end_block; b++) {
+    project_block_scalar(
+      &blocks->positions[(size_t)b * 3 * ProjectionBlockSize], projection,
+      output, &block);
+    const int first_vertex = b * ProjectionBlockSize;
+    const int remaining = blocks->vertex_count - first_vertex;
+    write_projected_block(
+      &block, first_vertex,
+      remaining < ProjectionBlockSize ? remaining : ProjectionBlockSize,
+      output);
+  }
+}
+
+// blocks [begin_block, end_block) with the widest vectors available
+static void project_blocks(
+  const position_blocks_t* blocks, const int begin_block, const int end_block,
+  const vertex_projection_t* projection, const projection_output_t* output) {
+#if defined(PROJECTION_AVX)
+  project_blocks_avx(blocks, begin_block, end_block, projection, output);
+#elif defined(PROJECTION_SSE2)
+  project_blocks_sse2(blocks, begin_block, end_block, projection, output);
+#else
+  project_blocks_scalar(blocks, begin_block, end_block, projection, output);
+#endif
+}
+
+void project_position_blocks(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  uint8_t* positions, const int position_stride, uint8_t* depth_recips,
+  const int depth_recip_stride, const bool half_depth_recips) {
+  project_blocks(
+    blocks, 0, blocks->block_count, projection,
+    &(projection_output_t){
+      .positions = positions,
+      .position_stride = position_stride,
+      .depth_recips = depth_recips,
+      .depth_recip_stride = depth_recip_stride,
+      .half_depth_recips = half_depth_recips});
+}
+
+void project_position_blocks_scalar(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  uint8_t* positions, const int position_stride, uint8_t* depth_recips,
+  const int depth_recip_stride, const bool half_depth_recips) {
+  project_blocks_scalar(
+    blocks, 0, blocks->block_count, projection,
+    &(projection_output_t){
+      .positions = positions,
+      .position_stride = position_stride,
+      .depth_recips = depth_recips,
+      .depth_recip_stride = depth_recip_stride,
+      .half_depth_recips = half_depth_recips});
+}
+
+// outputs start on a cache line (array.h and arena.h align to them) and
+// again every this many vertices of a stride
+static int vertices_per_cache_line(const int stride) {
+  int vertex_count = ProjectionCacheLineSize;
+  for (int s = stride; s % 2 == 0 && vertex_count > 1; s /= 2) {
+    vertex_count /= 2;
+  }
+  return vertex_count;
+}
+
+typedef struct projection_job_t {
+  const position_blocks_t* blocks;
+  const vertex_projection_t* projection;
+  const projection_output_t* output;
+  int blocks_per_job;
+} projection_job_t;
+
+static void projection_job(void* user_data, const int job_index) {
+  const projection_job_t* job = user_data;
+  const int begin_block = job_index * job->blocks_per_job;
+  const int end_block = begin_block + job->blocks_per_job;
+  project_blocks(
+    job->blocks, begin_block,
+    end_block < job->blocks->block_count ? end_block
+                                         : job->blocks->block_count,
+    job->projection, job->output);
+}
+
+int project_position_blocks_parallel(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  job_pool_t* pool, uint8_t* positions, const int position_stride,
+  uint8_t* depth_recips, const int depth_recip_stride,
+  const bool half_depth_recips) {
+  const projection_output_t output = {
+    .positions = positions,
+    .position_stride = position_stride,
+    .depth_recips = depth_recips,
+    .depth_recip_stride = depth_recip_stride,
+    .half_depth_recips = half_depth_recips};
+  const int thread_count = pool != NULL ? job_pool_thread_count(pool) : 1;
+  const int job_count =
+    blocks->vertex_count / MinProjectionJobVertexCount < thread_count
+      ? blocks->vertex_count / MinProjectionJobVertexCount
+      : thread_count;
+  if (job_count <= 1) {
+    project_blocks(blocks, 0, blocks->block_count, projection, &output);
+    return 1;
+  }
+  // jobs start on a cache line of both outputs, so no two threads write
+  // to the same line
+  int line_vertex_count = vertices_per_cache_line(position_stride);
+  if (vertices_per_cache_line(depth_recip_stride) > line_vertex_count) {
+    line_vertex_count = vertices_per_cache_line(depth_recip_stride);
+  }
+  const int line_block_count = line_vertex_count > ProjectionBlockSize
+                               ? line_vertex_count / ProjectionBlockSize
+                               : 1;
+  const int blocks_per_job =
+    ((blocks->block_count + job_count - 1) / job_count + line_block_count - 1)
+    / line_block_count * line_block_count;
+  const int run_job_count =
+    (blocks->block_count + blocks_per_job - 1) / blocks_per_job;
+  job_pool_run(
+    pool, run_job_count, projection_job,
+    &(projection_job_t){
+      .blocks = blocks,
+      .projection = projection,
+      .output = &output,
+      .blocks_per_job = blocks_per_job});
+  return run_job_count;
+}
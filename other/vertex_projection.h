@@ -0,0 +1,60 @@
+#ifndef VERTEX_PROJECTION_H
+#define VERTEX_PROJECTION_H
+
+#include "job_pool.h"
+
+#include <as-ops.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// vertices per block of position_blocks_t (two sse or one avx register)
+#define ProjectionBlockSize 8
+
+// positions regrouped so a block of vertices loads as whole registers, each
+// block stores the x, then the y, then the z coordinates of its vertices
+// (the last block is padded with copies of the last vertex)
+typedef struct position_blocks_t {
+  float* positions; // array.h array, 3 * ProjectionBlockSize per block
+  int vertex_count;
+  int block_count;
+} position_blocks_t;
+
+// model, view and projection concatenated once for every vertex
+typedef struct vertex_projection_t {
+  float model_view_projection[16]; // row major
+  float model_view_depth[4]; // row of model view giving the view space z
+} vertex_projection_t;
+
+// vertices are float3 positions
+position_blocks_t build_position_blocks(
+  const float* vertices, int vertex_count);
+void free_position_blocks(position_blocks_t* blocks);
+
+vertex_projection_t make_vertex_projection(
+  const as_mat34f* model, const as_mat34f* view, const as_mat44f* projection);
+
+// writes float3 projected positions (divided by w) every position_stride
+// bytes and the reciprocals of the view space depths every
+// depth_recip_stride bytes, as floats or as half2 (the second half zero)
+// when half_depth_recips is set, vectorized with sse2 (avx when enabled by
+// the compiler flags) where available, depth_recips may be NULL to only
+// write positions (the depths don't depend on the projection)
+void project_position_blocks(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  uint8_t* positions, int position_stride, uint8_t* depth_recips,
+  int depth_recip_stride, bool half_depth_recips);
+// project_position_blocks split across the threads of pool (run inline
+// when NULL or the mesh is small) in ranges starting on cache lines of both
+// outputs, returns the number of jobs the vertices were split into
+int project_position_blocks_parallel(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  job_pool_t* pool, uint8_t* positions, int position_stride,
+  uint8_t* depth_recips, int depth_recip_stride, bool half_depth_recips);
+// the same projection one vertex at a time (reference for the vectorized
+// version)
+void project_position_blocks_scalar(
+  const position_blocks_t* blocks, const vertex_projection_t* projection,
+  uint8_t* positions, int position_stride, uint8_t* depth_recips,
+  int depth_recip_stride, bool half_depth_recips);
+
+#endif // VERTEX_PROJECTION_H
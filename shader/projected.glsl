@@ -25,3 +25,33 @@ void main() {
 @end
 
 @program projected projected_vs projected_fs
+
+// projects the model through the pinned camera on the gpu, morph.x blends
+// from the standard (0) to the projected (1) positions, morph.y from affine
+// (0) to perspective correct (1) texturing through the pinned camera
+@vs projected_morph_vs
+uniform ProjectedMorphUniforms {
+  mat4 mvp;
+  mat4 model;
+  mat4 pinned_view_projection;
+  vec4 pinned_view_depth; // row of the pinned view giving the view space z
+  vec4 morph;
+};
+layout(location=0) in vec4 position;
+layout(location=1) in vec2 uv0;
+out vec2 uv;
+out float depth_recip;
+void main() {
+  vec4 world_position = model * position;
+  vec4 pinned_position = pinned_view_projection * world_position;
+  vec4 projected_position =
+    vec4(pinned_position.xyz / pinned_position.w, 1.0);
+  gl_Position = mvp * mix(world_position, projected_position, morph.x);
+  float depth_recip0 =
+    mix(1.0, 1.0 / dot(pinned_view_depth, world_position), morph.y);
+  uv = uv0 * depth_recip0;
+  depth_recip = depth_recip0;
+}
+@end
+
+@program projected_morph projected_morph_vs projected_fs
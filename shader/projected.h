@@ -24,10 +24,26 @@
                     Component Type: SG_SAMPLERTYPE_FLOAT
                     Bind slot: SLOT_the_texture = 0
 
+        Shader program 'projected_morph':
+            Get shader desc: projected_morph_shader_desc(sg_query_backend());
+            Vertex shader: projected_morph_vs
+                Attribute slots:
+                    ATTR_projected_morph_vs_position = 0
+                    ATTR_projected_morph_vs_uv0 = 1
+                Uniform block 'ProjectedMorphUniforms':
+                    C struct: ProjectedMorphUniforms_t
+                    Bind slot: SLOT_ProjectedMorphUniforms = 0
+            Fragment shader: projected_fs
+                Image 'the_texture':
+                    Type: SG_IMAGETYPE_2D
+                    Component Type: SG_SAMPLERTYPE_FLOAT
+                    Bind slot: SLOT_the_texture = 0
+
 
     Shader descriptor structs:
 
         sg_shader projected = sg_make_shader(projected_shader_desc(sg_query_backend()));
+        sg_shader projected_morph = sg_make_shader(projected_morph_shader_desc(sg_query_backend()));
 
     Vertex attribute locations for vertex shader 'projected_vs':
 
@@ -41,6 +57,17 @@
             },
             ...});
 
+    Vertex attribute locations for vertex shader 'projected_morph_vs':
+
+        sg_pipeline pip = sg_make_pipeline(&(sg_pipeline_desc){
+            .layout = {
+                .attrs = {
+                    [ATTR_projected_morph_vs_position] = { ... },
+                    [ATTR_projected_morph_vs_uv0] = { ... },
+                },
+            },
+            ...});
+
     Image bind slots, use as index in sg_bindings.vs_images[] or .fs_images[]
 
         SLOT_the_texture = 0;
@@ -52,6 +79,17 @@
         };
         sg_apply_uniforms(SG_SHADERSTAGE_[VS|FS], SLOT_ProjectedUniforms, &SG_RANGE(ProjectedUniforms));
 
+    Bind slot and C-struct for uniform block 'ProjectedMorphUniforms':
+
+        ProjectedMorphUniforms_t ProjectedMorphUniforms = {
+            .mvp = ...;
+            .model = ...;
+            .pinned_view_projection = ...;
+            .pinned_view_depth = ...;
+            .morph = ...;
+        };
+        sg_apply_uniforms(SG_SHADERSTAGE_[VS|FS], SLOT_ProjectedMorphUniforms, &SG_RANGE(ProjectedMorphUniforms));
+
 */
 #include <stdint.h>
 #include <stdbool.h>
@@ -67,13 +105,25 @@
 #define ATTR_projected_vs_position (0)
 #define ATTR_projected_vs_uv0 (1)
 #define ATTR_projected_vs_depth_recip0 (2)
+#define ATTR_projected_morph_vs_position (0)
+#define ATTR_projected_morph_vs_uv0 (1)
 #define SLOT_the_texture (0)
 #define SLOT_ProjectedUniforms (0)
+#define SLOT_ProjectedMorphUniforms (0)
 #pragma pack(push,1)
 SOKOL_SHDC_ALIGN(16) typedef struct ProjectedUniforms_t {
     float mvp[16];
 } ProjectedUniforms_t;
 #pragma pack(pop)
+#pragma pack(push,1)
+SOKOL_SHDC_ALIGN(16) typedef struct ProjectedMorphUniforms_t {
+    float mvp[16];
+    float model[16];
+    float pinned_view_projection[16];
+    float pinned_view_depth[4];
+    float morph[4];
+} ProjectedMorphUniforms_t;
+#pragma pack(pop)
 /*
     #version 330
     
@@ -150,6 +200,80 @@ static const char projected_fs_source_glsl330[204] = {
     0x76,0x20,0x2f,0x20,0x76,0x65,0x63,0x32,0x28,0x64,0x65,0x70,0x74,0x68,0x5f,0x72,
     0x65,0x63,0x69,0x70,0x29,0x29,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
+/*
+    #version 330
+    
+    uniform vec4 ProjectedMorphUniforms[14];
+    layout(location = 0) in vec4 position;
+    out vec2 uv;
+    layout(location = 1) in vec2 uv0;
+    out float depth_recip;
+    
+    void main()
+    {
+        vec4 _35 = mat4(ProjectedMorphUniforms[4], ProjectedMorphUniforms[5], ProjectedMorphUniforms[6], ProjectedMorphUniforms[7]) * position;
+        vec4 _42 = mat4(ProjectedMorphUniforms[8], ProjectedMorphUniforms[9], ProjectedMorphUniforms[10], ProjectedMorphUniforms[11]) * _35;
+        gl_Position = mat4(ProjectedMorphUniforms[0], ProjectedMorphUniforms[1], ProjectedMorphUniforms[2], ProjectedMorphUniforms[3]) * mix(_35, vec4(_42.xyz / vec3(_42.w), 1.0), vec4(ProjectedMorphUniforms[13].x));
+        float _71 = mix(1.0, 1.0 / dot(ProjectedMorphUniforms[12], _35), ProjectedMorphUniforms[13].y);
+        uv = uv0 * _71;
+        depth_recip = _71;
+    }
+    
+*/
+static const char projected_morph_vs_source_glsl330[816] = {
+    0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x33,0x30,0x0a,0x0a,0x75,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x50,0x72,0x6f,0x6a,0x65,
+    0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,
+    0x73,0x5b,0x31,0x34,0x5d,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,
+    0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x30,0x29,0x20,0x69,0x6e,0x20,0x76,
+    0x65,0x63,0x34,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x6f,0x75,
+    0x74,0x20,0x76,0x65,0x63,0x32,0x20,0x75,0x76,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,
+    0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x31,0x29,0x20,
+    0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x75,0x76,0x30,0x3b,0x0a,0x6f,0x75,0x74,
+    0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x64,0x65,0x70,0x74,0x68,0x5f,0x72,0x65,0x63,
+    0x69,0x70,0x3b,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,
+    0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x5f,0x33,0x35,0x20,
+    0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,
+    0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x34,0x5d,
+    0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,
+    0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x35,0x5d,0x2c,0x20,0x50,0x72,0x6f,
+    0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,
+    0x72,0x6d,0x73,0x5b,0x36,0x5d,0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,
+    0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x37,
+    0x5d,0x29,0x20,0x2a,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x5f,0x34,0x32,0x20,0x3d,0x20,0x6d,0x61,
+    0x74,0x34,0x28,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,
+    0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x38,0x5d,0x2c,0x20,0x50,0x72,
+    0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,
+    0x6f,0x72,0x6d,0x73,0x5b,0x39,0x5d,0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,
+    0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,
+    0x31,0x30,0x5d,0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,
+    0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x31,0x31,0x5d,0x29,
+    0x20,0x2a,0x20,0x5f,0x33,0x35,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,
+    0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x50,
+    0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,
+    0x66,0x6f,0x72,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,
+    0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,
+    0x5b,0x31,0x5d,0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,
+    0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,
+    0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x6d,0x69,0x78,
+    0x28,0x5f,0x33,0x35,0x2c,0x20,0x76,0x65,0x63,0x34,0x28,0x5f,0x34,0x32,0x2e,0x78,
+    0x79,0x7a,0x20,0x2f,0x20,0x76,0x65,0x63,0x33,0x28,0x5f,0x34,0x32,0x2e,0x77,0x29,
+    0x2c,0x20,0x31,0x2e,0x30,0x29,0x2c,0x20,0x76,0x65,0x63,0x34,0x28,0x50,0x72,0x6f,
+    0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,
+    0x72,0x6d,0x73,0x5b,0x31,0x33,0x5d,0x2e,0x78,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x37,0x31,0x20,0x3d,0x20,0x6d,0x69,0x78,
+    0x28,0x31,0x2e,0x30,0x2c,0x20,0x31,0x2e,0x30,0x20,0x2f,0x20,0x64,0x6f,0x74,0x28,
+    0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,
+    0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x31,0x32,0x5d,0x2c,0x20,0x5f,0x33,0x35,0x29,
+    0x2c,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x4d,0x6f,0x72,0x70,0x68,
+    0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x5b,0x31,0x33,0x5d,0x2e,0x79,0x29,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x75,0x76,0x30,0x20,0x2a,0x20,
+    0x5f,0x37,0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x64,0x65,0x70,0x74,0x68,0x5f,0x72,
+    0x65,0x63,0x69,0x70,0x20,0x3d,0x20,0x5f,0x37,0x31,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
+
+};
 /*
     cbuffer ProjectedUniforms : register(b0)
     {
@@ -382,6 +506,190 @@ static const char projected_fs_source_hlsl5[864] = {
     0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,0x0a,0x00,
 
 };
+/*
+    cbuffer ProjectedMorphUniforms : register(b0)
+    {
+        row_major float4x4 _27_mvp : packoffset(c0);
+        row_major float4x4 _27_model : packoffset(c4);
+        row_major float4x4 _27_pinned_view_projection : packoffset(c8);
+        float4 _27_pinned_view_depth : packoffset(c12);
+        float4 _27_morph : packoffset(c13);
+    };
+    
+    
+    static float4 gl_Position;
+    static float4 position;
+    static float2 uv;
+    static float2 uv0;
+    static float depth_recip;
+    
+    struct SPIRV_Cross_Input
+    {
+        float4 position : TEXCOORD0;
+        float2 uv0 : TEXCOORD1;
+    };
+    
+    struct SPIRV_Cross_Output
+    {
+        float2 uv : TEXCOORD0;
+        float depth_recip : TEXCOORD1;
+        float4 gl_Position : SV_Position;
+    };
+    
+    #line 45 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+    void vert_main()
+    {
+    #line 45 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        float4 _35 = mul(position, _27_model);
+    #line 46 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        float4 _42 = mul(_35, _27_pinned_view_projection);
+    #line 49 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        gl_Position = mul(lerp(_35, float4(_42.xyz / _42.w.xxx, 1.0f), _27_morph.x.xxxx), _27_mvp);
+    #line 51 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        float _71 = lerp(1.0f, 1.0f / dot(_27_pinned_view_depth, _35), _27_morph.y);
+    #line 52 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        uv = uv0 * _71;
+    #line 53 "/Users/tomhultonharrop/Documents/Projects/sokol-experiment/shader/projected.glsl"
+        depth_recip = _71;
+    }
+    
+    SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+    {
+        position = stage_input.position;
+        uv0 = stage_input.uv0;
+        vert_main();
+        SPIRV_Cross_Output stage_output;
+        stage_output.gl_Position = gl_Position;
+        stage_output.uv = uv;
+        stage_output.depth_recip = depth_recip;
+        return stage_output;
+    }
+*/
+static const char projected_morph_vs_source_hlsl5[1953] = {
+    0x63,0x62,0x75,0x66,0x66,0x65,0x72,0x20,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,
+    0x64,0x4d,0x6f,0x72,0x70,0x68,0x55,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x73,0x20,0x3a,
+    0x20,0x72,0x65,0x67,0x69,0x73,0x74,0x65,0x72,0x28,0x62,0x30,0x29,0x0a,0x7b,0x0a,
+    0x20,0x20,0x20,0x20,0x72,0x6f,0x77,0x5f,0x6d,0x61,0x6a,0x6f,0x72,0x20,0x66,0x6c,
+    0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x76,0x70,0x20,0x3a,
+    0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,0x66,0x73,0x65,0x74,0x28,0x63,0x30,0x29,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x72,0x6f,0x77,0x5f,0x6d,0x61,0x6a,0x6f,0x72,0x20,0x66,
+    0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x6f,0x64,0x65,
+    0x6c,0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,0x66,0x73,0x65,0x74,0x28,0x63,
+    0x34,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x72,0x6f,0x77,0x5f,0x6d,0x61,0x6a,0x6f,
+    0x72,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x78,0x34,0x20,0x5f,0x32,0x37,0x5f,0x70,
+    0x69,0x6e,0x6e,0x65,0x64,0x5f,0x76,0x69,0x65,0x77,0x5f,0x70,0x72,0x6f,0x6a,0x65,
+    0x63,0x74,0x69,0x6f,0x6e,0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,0x66,0x73,
+    0x65,0x74,0x28,0x63,0x38,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
+    0x74,0x34,0x20,0x5f,0x32,0x37,0x5f,0x70,0x69,0x6e,0x6e,0x65,0x64,0x5f,0x76,0x69,
+    0x65,0x77,0x5f,0x64,0x65,0x70,0x74,0x68,0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,
+    0x66,0x66,0x73,0x65,0x74,0x28,0x63,0x31,0x32,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,
+    0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x6f,0x72,0x70,0x68,
+    0x20,0x3a,0x20,0x70,0x61,0x63,0x6b,0x6f,0x66,0x66,0x73,0x65,0x74,0x28,0x63,0x31,
+    0x33,0x29,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,
+    0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,
+    0x6f,0x6e,0x3b,0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x34,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x73,0x74,0x61,0x74,
+    0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,0x76,0x3b,0x0a,0x73,0x74,
+    0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,0x76,0x30,0x3b,
+    0x0a,0x73,0x74,0x61,0x74,0x69,0x63,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x64,0x65,
+    0x70,0x74,0x68,0x5f,0x72,0x65,0x63,0x69,0x70,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,
+    0x63,0x74,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,
+    0x6e,0x70,0x75,0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x34,0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3a,0x20,0x54,0x45,0x58,
+    0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,
+    0x74,0x32,0x20,0x75,0x76,0x30,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,
+    0x44,0x31,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x73,0x74,0x72,0x75,0x63,0x74,0x20,0x53,
+    0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,0x74,0x70,0x75,
+    0x74,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x32,0x20,0x75,
+    0x76,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x30,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x64,0x65,0x70,0x74,0x68,0x5f,0x72,
+    0x65,0x63,0x69,0x70,0x20,0x3a,0x20,0x54,0x45,0x58,0x43,0x4f,0x4f,0x52,0x44,0x31,
+    0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x67,0x6c,0x5f,
+    0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3a,0x20,0x53,0x56,0x5f,0x50,0x6f,
+    0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x7d,0x3b,0x0a,0x0a,0x23,0x6c,0x69,0x6e,
+    0x65,0x20,0x34,0x35,0x20,0x22,0x2f,0x55,0x73,0x65,0x72,0x73,0x2f,0x74,0x6f,0x6d,
+    0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,0x6f,0x70,0x2f,0x44,0x6f,0x63,
+    0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x73,0x2f,
+    0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,0x72,0x69,0x6d,0x65,0x6e,0x74,
+    0x2f,0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,
+    0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x76,0x6f,0x69,0x64,0x20,0x76,0x65,0x72,
+    0x74,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x23,0x6c,0x69,0x6e,0x65,
+    0x20,0x34,0x35,0x20,0x22,0x2f,0x55,0x73,0x65,0x72,0x73,0x2f,0x74,0x6f,0x6d,0x68,
+    0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,0x6f,0x70,0x2f,0x44,0x6f,0x63,0x75,
+    0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x73,0x2f,0x73,
+    0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,0x72,0x69,0x6d,0x65,0x6e,0x74,0x2f,
+    0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,
+    0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x34,0x20,0x5f,0x33,0x35,0x20,0x3d,0x20,0x6d,0x75,0x6c,0x28,0x70,0x6f,0x73,0x69,
+    0x74,0x69,0x6f,0x6e,0x2c,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x6f,0x64,0x65,0x6c,0x29,
+    0x3b,0x0a,0x23,0x6c,0x69,0x6e,0x65,0x20,0x34,0x36,0x20,0x22,0x2f,0x55,0x73,0x65,
+    0x72,0x73,0x2f,0x74,0x6f,0x6d,0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,
+    0x6f,0x70,0x2f,0x44,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,
+    0x6a,0x65,0x63,0x74,0x73,0x2f,0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,
+    0x72,0x69,0x6d,0x65,0x6e,0x74,0x2f,0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,
+    0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x20,0x20,
+    0x20,0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x20,0x5f,0x34,0x32,0x20,0x3d,0x20,0x6d,
+    0x75,0x6c,0x28,0x5f,0x33,0x35,0x2c,0x20,0x5f,0x32,0x37,0x5f,0x70,0x69,0x6e,0x6e,
+    0x65,0x64,0x5f,0x76,0x69,0x65,0x77,0x5f,0x70,0x72,0x6f,0x6a,0x65,0x63,0x74,0x69,
+    0x6f,0x6e,0x29,0x3b,0x0a,0x23,0x6c,0x69,0x6e,0x65,0x20,0x34,0x39,0x20,0x22,0x2f,
+    0x55,0x73,0x65,0x72,0x73,0x2f,0x74,0x6f,0x6d,0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,
+    0x61,0x72,0x72,0x6f,0x70,0x2f,0x44,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,
+    0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,0x73,0x2f,0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,
+    0x78,0x70,0x65,0x72,0x69,0x6d,0x65,0x6e,0x74,0x2f,0x73,0x68,0x61,0x64,0x65,0x72,
+    0x2f,0x70,0x72,0x6f,0x6a,0x65,0x63,0x74,0x65,0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,
+    0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,
+    0x20,0x3d,0x20,0x6d,0x75,0x6c,0x28,0x6c,0x65,0x72,0x70,0x28,0x5f,0x33,0x35,0x2c,
+    0x20,0x66,0x6c,0x6f,0x61,0x74,0x34,0x28,0x5f,0x34,0x32,0x2e,0x78,0x79,0x7a,0x20,
+    0x2f,0x20,0x5f,0x34,0x32,0x2e,0x77,0x2e,0x78,0x78,0x78,0x2c,0x20,0x31,0x2e,0x30,
+    0x66,0x29,0x2c,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x6f,0x72,0x70,0x68,0x2e,0x78,0x2e,
+    0x78,0x78,0x78,0x78,0x29,0x2c,0x20,0x5f,0x32,0x37,0x5f,0x6d,0x76,0x70,0x29,0x3b,
+    0x0a,0x23,0x6c,0x69,0x6e,0x65,0x20,0x35,0x31,0x20,0x22,0x2f,0x55,0x73,0x65,0x72,
+    0x73,0x2f,0x74,0x6f,0x6d,0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,0x6f,
+    0x70,0x2f,0x44,0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,0x6a,
+    0x65,0x63,0x74,0x73,0x2f,0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,0x72,
+    0x69,0x6d,0x65,0x6e,0x74,0x2f,0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,0x6f,
+    0x6a,0x65,0x63,0x74,0x65,0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x20,0x20,0x20,
+    0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x5f,0x37,0x31,0x20,0x3d,0x20,0x6c,0x65,0x72,
+    0x70,0x28,0x31,0x2e,0x30,0x66,0x2c,0x20,0x31,0x2e,0x30,0x66,0x20,0x2f,0x20,0x64,
+    0x6f,0x74,0x28,0x5f,0x32,0x37,0x5f,0x70,0x69,0x6e,0x6e,0x65,0x64,0x5f,0x76,0x69,
+    0x65,0x77,0x5f,0x64,0x65,0x70,0x74,0x68,0x2c,0x20,0x5f,0x33,0x35,0x29,0x2c,0x20,
+    0x5f,0x32,0x37,0x5f,0x6d,0x6f,0x72,0x70,0x68,0x2e,0x79,0x29,0x3b,0x0a,0x23,0x6c,
+    0x69,0x6e,0x65,0x20,0x35,0x32,0x20,0x22,0x2f,0x55,0x73,0x65,0x72,0x73,0x2f,0x74,
+    0x6f,0x6d,0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,0x6f,0x70,0x2f,0x44,
+    0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,
+    0x73,0x2f,0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,0x72,0x69,0x6d,0x65,
+    0x6e,0x74,0x2f,0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,0x6f,0x6a,0x65,0x63,
+    0x74,0x65,0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,
+    0x20,0x3d,0x20,0x75,0x76,0x30,0x20,0x2a,0x20,0x5f,0x37,0x31,0x3b,0x0a,0x23,0x6c,
+    0x69,0x6e,0x65,0x20,0x35,0x33,0x20,0x22,0x2f,0x55,0x73,0x65,0x72,0x73,0x2f,0x74,
+    0x6f,0x6d,0x68,0x75,0x6c,0x74,0x6f,0x6e,0x68,0x61,0x72,0x72,0x6f,0x70,0x2f,0x44,
+    0x6f,0x63,0x75,0x6d,0x65,0x6e,0x74,0x73,0x2f,0x50,0x72,0x6f,0x6a,0x65,0x63,0x74,
+    0x73,0x2f,0x73,0x6f,0x6b,0x6f,0x6c,0x2d,0x65,0x78,0x70,0x65,0x72,0x69,0x6d,0x65,
+    0x6e,0x74,0x2f,0x73,0x68,0x61,0x64,0x65,0x72,0x2f,0x70,0x72,0x6f,0x6a,0x65,0x63,
+    0x74,0x65,0x64,0x2e,0x67,0x6c,0x73,0x6c,0x22,0x0a,0x20,0x20,0x20,0x20,0x64,0x65,
+    0x70,0x74,0x68,0x5f,0x72,0x65,0x63,0x69,0x70,0x20,0x3d,0x20,0x5f,0x37,0x31,0x3b,
+    0x0a,0x7d,0x0a,0x0a,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,
+    0x4f,0x75,0x74,0x70,0x75,0x74,0x20,0x6d,0x61,0x69,0x6e,0x28,0x53,0x50,0x49,0x52,
+    0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x49,0x6e,0x70,0x75,0x74,0x20,0x73,0x74,
+    0x61,0x67,0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,
+    0x20,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,
+    0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x70,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,
+    0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x30,0x20,0x3d,0x20,0x73,0x74,0x61,0x67,
+    0x65,0x5f,0x69,0x6e,0x70,0x75,0x74,0x2e,0x75,0x76,0x30,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x76,0x65,0x72,0x74,0x5f,0x6d,0x61,0x69,0x6e,0x28,0x29,0x3b,0x0a,0x20,0x20,
+    0x20,0x20,0x53,0x50,0x49,0x52,0x56,0x5f,0x43,0x72,0x6f,0x73,0x73,0x5f,0x4f,0x75,
+    0x74,0x70,0x75,0x74,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,
+    0x74,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,
+    0x70,0x75,0x74,0x2e,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x20,
+    0x3d,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,
+    0x20,0x20,0x20,0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,
+    0x75,0x76,0x20,0x3d,0x20,0x75,0x76,0x3b,0x0a,0x20,0x20,0x20,0x20,0x73,0x74,0x61,
+    0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x2e,0x64,0x65,0x70,0x74,0x68,0x5f,
+    0x72,0x65,0x63,0x69,0x70,0x20,0x3d,0x20,0x64,0x65,0x70,0x74,0x68,0x5f,0x72,0x65,
+    0x63,0x69,0x70,0x3b,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,
+    0x73,0x74,0x61,0x67,0x65,0x5f,0x6f,0x75,0x74,0x70,0x75,0x74,0x3b,0x0a,0x7d,0x0a,
+    0x00,
+};
 #if !defined(SOKOL_GFX_INCLUDED)
   #error "Please include sokol_gfx.h before projected.h"
 #endif
@@ -438,3 +746,53 @@ static inline const sg_shader_desc* projected_shader_desc(sg_backend backend) {
   }
   return 0;
 }
+static inline const sg_shader_desc* projected_morph_shader_desc(sg_backend backend) {
+  if (backend == SG_BACKEND_GLCORE33) {
+    static sg_shader_desc desc;
+    static bool valid;
+    if (!valid) {
+      valid = true;
+      desc.attrs[0].name = "position";
+      desc.attrs[1].name = "uv0";
+      desc.vs.source = projected_morph_vs_source_glsl330;
+      desc.vs.entry = "main";
+      desc.vs.uniform_blocks[0].size = 224;
+      desc.vs.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
+      desc.vs.uniform_blocks[0].uniforms[0].name = "ProjectedMorphUniforms";
+      desc.vs.uniform_blocks[0].uniforms[0].type = SG_UNIFORMTYPE_FLOAT4;
+      desc.vs.uniform_blocks[0].uniforms[0].array_count = 14;
+      desc.fs.source = projected_fs_source_glsl330;
+      desc.fs.entry = "main";
+      desc.fs.images[0].name = "the_texture";
+      desc.fs.images[0].image_type = SG_IMAGETYPE_2D;
+      desc.fs.images[0].sampler_type = SG_SAMPLERTYPE_FLOAT;
+      desc.label = "projected_morph_shader";
+    }
+    return &desc;
+  }
+  if (backend == SG_BACKEND_D3D11) {
+    static sg_shader_desc desc;
+    static bool valid;
+    if (!valid) {
+      valid = true;
+      desc.attrs[0].sem_name = "TEXCOORD";
+      desc.attrs[0].sem_index = 0;
+      desc.attrs[1].sem_name = "TEXCOORD";
+      desc.attrs[1].sem_index = 1;
+      desc.vs.source = projected_morph_vs_source_hlsl5;
+      desc.vs.d3d11_target = "vs_5_0";
+      desc.vs.entry = "main";
+      desc.vs.uniform_blocks[0].size = 224;
+      desc.vs.uniform_blocks[0].layout = SG_UNIFORMLAYOUT_STD140;
+      desc.fs.source = projected_fs_source_hlsl5;
+      desc.fs.d3d11_target = "ps_5_0";
+      desc.fs.entry = "main";
+      desc.fs.images[0].name = "the_texture";
+      desc.fs.images[0].image_type = SG_IMAGETYPE_2D;
+      desc.fs.images[0].sampler_type = SG_SAMPLERTYPE_FLOAT;
+      desc.label = "projected_morph_shader";
+    }
+    return &desc;
+  }
+  return 0;
+}